@@ -101,6 +101,9 @@ bool            enable_sm          = true;
 bool            enable_bench       = true;
 bool            enable_mch_read    = true;
 bool            enable_numa        = false;
+bool            enable_numa_remote = false;
+bool            enable_service_core = false;
+bool            enable_envlog      = false;
 
 bool            enable_ecc_polling = false;
 
@@ -109,6 +112,10 @@ bool            dark_mode          = false;
 
 power_save_t    power_save         = POWER_SAVE_HIGH;
 
+access_order_t  access_order       = ACCESS_ORDER_LINEAR;
+
+copy_engine_t   copy_engine        = COPY_ENGINE_MOVS;
+
 bool            enable_tty         = false;
 uintptr_t       tty_address        = 0x3F8;             // Legacy IO or MMIO Address accepted
 int             tty_baud_rate      = 115200;
@@ -331,8 +338,40 @@ static void parse_option(const char *option, const char *params)
         smp_enabled = false;
     } else if (strncmp(option, "numa", 5) == 0) {
         enable_numa = true;
+        enable_numa_remote = (params != NULL && strncmp(params, "remote", 7) == 0);
     } else if (strncmp(option, "nonuma", 7) == 0) {
         enable_numa = false;
+        enable_numa_remote = false;
+    } else if (strncmp(option, "servicecore", 12) == 0) {
+        enable_service_core = true;
+    } else if (strncmp(option, "envlog", 7) == 0) {
+        enable_envlog = true;
+    } else if (strncmp(option, "order", 6) == 0 && params != NULL) {
+        if (strncmp(params, "linear", 7) == 0) {
+            access_order = ACCESS_ORDER_LINEAR;
+        } else if (strncmp(params, "bank", 5) == 0) {
+            access_order = ACCESS_ORDER_BANK;
+        } else if (strncmp(params, "conflict", 9) == 0) {
+            access_order = ACCESS_ORDER_CONFLICT;
+        } else if (strncmp(params, "random", 7) == 0) {
+            access_order = ACCESS_ORDER_RANDOM;
+        } else if (strncmp(params, "cycle", 6) == 0) {
+            access_order = ACCESS_ORDER_CYCLE;
+        }
+    } else if (strncmp(option, "copy", 5) == 0 && params != NULL) {
+        if (strncmp(params, "movs", 5) == 0) {
+            copy_engine = COPY_ENGINE_MOVS;
+        } else if (strncmp(params, "movsb", 6) == 0) {
+            copy_engine = COPY_ENGINE_MOVSB;
+        } else if (strncmp(params, "nt", 3) == 0) {
+            copy_engine = COPY_ENGINE_NT;
+        } else if (strncmp(params, "avx2", 5) == 0) {
+            copy_engine = COPY_ENGINE_AVX2;
+        } else if (strncmp(params, "avx512", 7) == 0) {
+            copy_engine = COPY_ENGINE_AVX512;
+        } else if (strncmp(params, "cycle", 6) == 0) {
+            copy_engine = COPY_ENGINE_CYCLE;
+        }
     } else if (strncmp(option, "powersave", 10) == 0) {
         if (strncmp(params, "off", 4) == 0) {
             power_save = POWER_SAVE_OFF;
@@ -350,6 +389,8 @@ static void parse_option(const char *option, const char *params)
         } else if (strncmp(params, "kbd", 4) == 0) {
             usb_init_options |= USB_DEBUG_KBD;
 	}
+    } else if (strncmp(option, "usbdefer", 9) == 0) {
+        usb_init_options |= USB_DEFERRED_INIT;
     } else if (strncmp(option, "usbinit", 8) == 0) {
         if (strncmp(params, "1", 2) == 0) {
             usb_init_options |= USB_2_STEP_INIT;
@@ -37,6 +37,23 @@ typedef enum {
     POWER_SAVE_HIGH
 } power_save_t;
 
+typedef enum {
+    ACCESS_ORDER_LINEAR,
+    ACCESS_ORDER_BANK,
+    ACCESS_ORDER_CONFLICT,
+    ACCESS_ORDER_RANDOM,
+    ACCESS_ORDER_CYCLE
+} access_order_t;
+
+typedef enum {
+    COPY_ENGINE_MOVS,
+    COPY_ENGINE_MOVSB,
+    COPY_ENGINE_NT,
+    COPY_ENGINE_AVX2,
+    COPY_ENGINE_AVX512,
+    COPY_ENGINE_CYCLE
+} copy_engine_t;
+
 extern uintptr_t    pm_limit_lower;
 extern uintptr_t    pm_limit_upper;
 
@@ -65,12 +82,19 @@ extern bool         enable_bench;
 extern bool         enable_mch_read;
 extern bool         enable_ecc_polling;
 extern bool         enable_numa;
+extern bool         enable_numa_remote;
+extern bool         enable_service_core;
+extern bool         enable_envlog;
 
 extern bool         pause_at_start;
 extern bool         dark_mode;
 
 extern power_save_t power_save;
 
+extern access_order_t access_order;
+
+extern copy_engine_t copy_engine;
+
 extern uintptr_t    tty_address;
 extern int          tty_baud_rate;
 extern int          tty_update_period;
@@ -23,6 +23,7 @@
 #include "spinlock.h"
 
 #include "config.h"
+#include "envlog.h"
 #include "error.h"
 #include "build_version.h"
 
@@ -74,6 +75,11 @@ static uint64_t next_spin_time = 0; // TSC time stamp
 static int prev_sec = -1;               // previous second
 static bool timed_update_done = false;  // update cycle status
 
+static int shown_test_ticks = -1;       // last value displayed by the service core
+
+static volatile bool service_hold = false;  // set while the master owns the screen
+static spinlock_t service_busy = false;     // set while the service core updates the screen
+
 bool big_status_displayed = false;
 static uint16_t popup_status_save_buffer[POP_STAT_W * POP_STAT_H];
 
@@ -85,6 +91,8 @@ int scroll_message_row;
 
 int max_cpu_temp = TEMP_INVALID;
 
+static int cur_cpu_temp = TEMP_INVALID;
+
 display_mode_t display_mode = DISPLAY_MODE_NA;
 
 screen_palette_t palette = {BLUE, WHITE, WHITE, BLACK, WHITE, BLUE, BLACK};
@@ -405,6 +413,7 @@ void display_temperature(void)
     if (enable_temp_cpu) {
         // Display CPU Temperature
         int actual_cpu_temp = get_cpu_temp();
+        cur_cpu_temp = actual_cpu_temp;
 
         if (actual_cpu_temp == TEMP_INVALID) {
             if (max_cpu_temp == TEMP_INVALID) {
@@ -431,10 +440,12 @@ void display_temperature(void)
                 if (!ram_slot_info[i].isPopulated || !ram_slot_info[i].hasTempSensor)
                     continue;
 
-                int ram_temp = get_ram_temp(i);
+                // The sensors are read by sample_ram_temp(), so the SMBus
+                // transactions are spread out over time.
+                const ram_temp_history_t *history = get_ram_temp_history(i);
 
-                if (ram_temp != TEMP_INVALID) {
-                    display_ram_temperature(ram_temp, ram_slot_info[i].display_idx)
+                if (history != NULL) {
+                    display_ram_temperature(history->latest, ram_slot_info[i].display_idx)
                 }
             }
         }
@@ -495,7 +506,14 @@ void check_input(void)
 
     if (input_key == '\0') {
         return;
-    } else if (big_status_displayed) {
+    }
+
+    // Stop the service core from drawing over any pop-up we display.
+    service_hold = true;
+    __sync_synchronize();
+    spin_wait(&service_busy);
+
+    if (big_status_displayed) {
         restore_big_status();
         enable_big_status = false;
     }
@@ -509,6 +527,12 @@ void check_input(void)
       case '1':
         config_menu(false);
         break;
+      case '3':
+        envlog_dump(false);
+        if (enable_tty) {
+            tty_full_redraw();
+        }
+        break;
       case ' ':
         set_scroll_lock(!scroll_lock);
         break;
@@ -518,6 +542,8 @@ void check_input(void)
       default:
         break;
     }
+
+    service_hold = false;
 }
 
 void set_scroll_lock(bool enabled)
@@ -552,34 +578,8 @@ void scroll(void)
     }
 }
 
-void do_tick(int my_cpu)
+static void display_progress(void)
 {
-    int act_sec = 0;
-    bool use_spin_wait = (power_save < POWER_SAVE_HIGH);
-    if (use_spin_wait) {
-        barrier_spin_wait(run_barrier);
-    } else {
-        barrier_halt_wait(run_barrier);
-    }
-
-    if (master_cpu == my_cpu) {
-        check_input();
-        error_update();
-    }
-    if (use_spin_wait) {
-        barrier_spin_wait(run_barrier);
-    } else {
-        barrier_halt_wait(run_barrier);
-    }
-
-    // Only the master CPU does the update.
-    if (master_cpu != my_cpu) {
-        return;
-    }
-
-    test_ticks++;
-    pass_ticks++;
-
     pass_type_t pass_type = (pass_num == 0) ? FAST_PASS : FULL_PASS;
 
     int pct = 0;
@@ -601,12 +601,19 @@ void do_tick(int my_cpu)
     }
     display_pass_percentage(pct);
     display_pass_bar((BAR_LENGTH * pct) / 100);
+}
+
+static void display_timed_updates(void)
+{
+    int act_sec  = 0;
+    int run_time = -1;
 
     bool update_spinner = true;
     if (clks_per_msec > 0) {
         uint64_t current_time = get_tsc();
 
         int secs  = (current_time - run_start_time) / (1000 * (uint64_t)clks_per_msec);
+        run_time  = secs;
         int mins  = secs / 60; secs %= 60; act_sec = secs;
         int hours = mins / 60; mins %= 60;
         display_run_time(hours, mins, secs);
@@ -628,6 +635,11 @@ void do_tick(int my_cpu)
         display_spinner(spin_state[spin_idx]);
     }
 
+    // Read the next RAM temperature sensor, if one is due
+    if (enable_temp_ram) {
+        sample_ram_temp();
+    }
+
     // This only tick one time per second
     if (!timed_update_done) {
 
@@ -642,6 +654,11 @@ void do_tick(int my_cpu)
         // Update temperature
         display_temperature();
 
+        // Record the test environment
+        if (run_time >= 0) {
+            envlog_record(run_time, enable_temp_cpu ? cur_cpu_temp : TEMP_INVALID);
+        }
+
         // Update TTY one time every TTY_UPDATE_PERIOD second(s)
         if (enable_tty) {
 
@@ -659,6 +676,67 @@ void do_tick(int my_cpu)
     }
 }
 
+void do_tick(int my_cpu)
+{
+    barrier_t *barrier = test_barrier(my_cpu);
+
+    bool use_spin_wait = (power_save < POWER_SAVE_HIGH);
+    if (use_spin_wait) {
+        barrier_spin_wait(barrier);
+    } else {
+        barrier_halt_wait(barrier);
+    }
+
+    if (master_cpu == my_cpu) {
+        check_input();
+        if (service_cpu < 0) {
+            error_update();
+        }
+    }
+    if (use_spin_wait) {
+        barrier_spin_wait(barrier);
+    } else {
+        barrier_halt_wait(barrier);
+    }
+
+    // Only the master CPU does the update.
+    if (master_cpu != my_cpu) {
+        return;
+    }
+
+    test_ticks++;
+    pass_ticks++;
+
+    // If there is a service core, it does the rest.
+    if (service_cpu >= 0) {
+        return;
+    }
+
+    display_progress();
+
+    display_timed_updates();
+
+    screen_flush();
+}
+
+void do_service_tick(void)
+{
+    keyboard_service_poll();
+
+    service_busy = true;
+    __sync_synchronize();
+    if (!service_hold) {
+        if (test_ticks != shown_test_ticks) {
+            shown_test_ticks = test_ticks;
+            error_update();
+            display_progress();
+        }
+        display_timed_updates();
+        screen_flush();
+    }
+    spin_unlock(&service_busy);
+}
+
 void do_trace(int my_cpu, const char *fmt, ...)
 {
     va_list args;
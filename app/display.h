@@ -284,6 +284,8 @@ void scroll(void);
 
 void do_tick(int my_cpu);
 
+void do_service_tick(void);
+
 void do_trace(int my_cpu, const char *fmt, ...);
 
 #endif // DISPLAY_H
@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuinfo.h"
+#include "heap.h"
+#include "serial.h"
+#include "spd.h"
+#include "temperature.h"
+
+#include "config.h"
+#include "error.h"
+#include "test.h"
+
+#include "string.h"
+
+#include "envlog.h"
+
+//------------------------------------------------------------------------------
+// Constants
+//------------------------------------------------------------------------------
+
+#define NO_TEMP     INT8_MIN
+
+//------------------------------------------------------------------------------
+// Types
+//------------------------------------------------------------------------------
+
+typedef struct {
+    uint32_t    run_time;
+    uint32_t    error_count;
+    uint32_t    cecc_count;
+    uint16_t    pass_num;
+    uint16_t    cpu_freq;
+    uint8_t     test_num;
+    int8_t      cpu_temp;
+    int8_t      ram_temp[MAX_SPD_SLOT];
+} envlog_entry_t;
+
+//------------------------------------------------------------------------------
+// Private Variables
+//------------------------------------------------------------------------------
+
+static envlog_entry_t *env_log = NULL;
+
+static uint32_t num_records = 0;    // total added since the last reset
+static uint32_t num_dumped  = 0;    // total sent by the last incremental dump
+
+//------------------------------------------------------------------------------
+// Private Functions
+//------------------------------------------------------------------------------
+
+static int8_t pack_temp(int temp)
+{
+    if (temp == TEMP_INVALID || temp <= NO_TEMP) {
+        return NO_TEMP;
+    }
+    return temp > INT8_MAX ? INT8_MAX : temp;
+}
+
+static uint32_t saturate(uint64_t count)
+{
+    return count > INT32_MAX ? INT32_MAX : count;
+}
+
+static void send_field(int value, bool valid, bool last)
+{
+    char s[12];
+
+    if (valid) {
+        tty_write(itoa(value, s));
+    }
+    tty_write(last ? "\r\n" : ",");
+}
+
+static void send_entry(const envlog_entry_t *entry)
+{
+    send_field(entry->run_time,    true, false);
+    send_field(entry->pass_num,    true, false);
+    send_field(entry->test_num,    true, false);
+    send_field(entry->cpu_temp,    entry->cpu_temp != NO_TEMP, false);
+    send_field(entry->cpu_freq,    entry->cpu_freq != 0, false);
+    send_field(entry->error_count, true, false);
+    send_field(entry->cecc_count,  true, false);
+    for (int i = 0; i < MAX_SPD_SLOT; i++) {
+        send_field(entry->ram_temp[i], entry->ram_temp[i] != NO_TEMP, i == MAX_SPD_SLOT - 1);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Public Functions
+//------------------------------------------------------------------------------
+
+void envlog_init(void)
+{
+    uintptr_t addr = heap_alloc(HEAP_TYPE_HM_1, ENVLOG_SIZE * sizeof(envlog_entry_t), sizeof(uint32_t));
+    env_log = (envlog_entry_t *)addr;
+    envlog_reset();
+}
+
+void envlog_reset(void)
+{
+    num_records = 0;
+    num_dumped  = 0;
+}
+
+void envlog_record(uint32_t run_time, int cpu_temp)
+{
+    if (env_log == NULL) {
+        return;
+    }
+
+    envlog_entry_t *entry = &env_log[num_records % ENVLOG_SIZE];
+
+    entry->run_time    = run_time;
+    entry->error_count = saturate(error_count);
+    entry->cecc_count  = saturate(error_count_cecc);
+    entry->pass_num    = pass_num;
+    entry->cpu_freq    = get_effective_cpu_freq();
+    entry->test_num    = test_num;
+    entry->cpu_temp    = pack_temp(cpu_temp);
+    for (int i = 0; i < MAX_SPD_SLOT; i++) {
+        const ram_temp_history_t *history = get_ram_temp_history(i);
+        entry->ram_temp[i] = pack_temp(history != NULL ? history->latest : TEMP_INVALID);
+    }
+
+    // Make sure the record is complete before it becomes visible to a dump.
+    __sync_synchronize();
+    num_records++;
+}
+
+void envlog_dump(bool new_only)
+{
+    if (env_log == NULL || !enable_tty) {
+        return;
+    }
+
+    uint32_t end   = num_records;
+    uint32_t start = new_only ? num_dumped : 0;
+    if (end - start > ENVLOG_SIZE) {
+        start = end - ENVLOG_SIZE;
+    }
+
+    tty_write("\r\n# envlog: time,pass,test,cpu_temp,cpu_mhz,errors,cecc");
+    for (int i = 0; i < MAX_SPD_SLOT; i++) {
+        char s[4];
+        tty_write(",dimm");
+        tty_write(itoa(i, s));
+    }
+    tty_write("\r\n");
+    for (uint32_t i = start; i < end; i++) {
+        send_entry(&env_log[i % ENVLOG_SIZE]);
+    }
+    tty_write("# envlog end\r\n");
+
+    if (new_only) {
+        num_dumped = end;
+    }
+}
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: GPL-2.0
+#ifndef ENVLOG_H
+#define ENVLOG_H
+/**
+ * \file
+ *
+ * Provides a time-series log of the test environment (temperatures, CPU
+ * clock speed, and error counts), recorded once per second of run time,
+ * so that errors can be correlated with the conditions at the time they
+ * occurred. The log is held in pinned memory and can be dumped to the
+ * serial console.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * The maximum number of records held in the log. When the log is full, the
+ * oldest records are overwritten.
+ */
+#define ENVLOG_SIZE     4096
+
+/**
+ * Allocates the log in pinned memory. Must be called before the heap is
+ * used for anything that is later released.
+ */
+void envlog_init(void);
+
+/**
+ * Discards all records. Called at the start of each run.
+ */
+void envlog_reset(void);
+
+/**
+ * Adds a record for the given run time (in seconds) and CPU temperature.
+ * The remaining values are read from the current test state.
+ */
+void envlog_record(uint32_t run_time, int cpu_temp);
+
+/**
+ * Sends the records to the serial console as comma-separated values. If
+ * new_only is true, only the records added since the previous dump are sent.
+ * Does nothing if the serial console is not enabled.
+ */
+void envlog_dump(bool new_only);
+
+#endif // ENVLOG_H
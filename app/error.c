@@ -23,6 +23,7 @@
 
 #include "tests.h"
 #include "serial.h"
+#include "ecc.h"
 #include "memctrl.h"
 #include "error.h"
 
@@ -34,6 +35,16 @@
 #define USB_WORKAROUND 1
 #endif
 
+// The error count for each test is shown in two columns, to the right of the
+// error summary, each with a heading row above it.
+#define TEST_TABLE_ROWS     ((NUM_TEST_PATTERNS + 1) / 2)
+#define TEST_TABLE_COL(i)   (55 + 12 * ((i) / TEST_TABLE_ROWS))
+#define TEST_TABLE_ROW(i)   (1 + (i) % TEST_TABLE_ROWS)
+
+#if TEST_TABLE_ROWS > ROW_MESSAGE_B - ROW_MESSAGE_T
+#error "The per-test error table doesn't fit above the footer"
+#endif
+
 //------------------------------------------------------------------------------
 // Types
 //------------------------------------------------------------------------------
@@ -83,6 +94,18 @@ uint64_t                error_count_cecc = 0;
 // Private Functions
 //------------------------------------------------------------------------------
 
+// Shows the error count for the given test in the per-test error table. Each
+// column has room for 7 digits.
+static void display_test_errors(int test)
+{
+    if (test_list[test].errors > 9999999) {
+        display_pinned_message(TEST_TABLE_ROW(test), TEST_TABLE_COL(test) + 5, ">9999999");
+    } else {
+        display_pinned_message(TEST_TABLE_ROW(test), TEST_TABLE_COL(test) + 5, " %i",
+                               test_list[test].errors);
+    }
+}
+
 static bool update_error_info(testword_t page, testword_t offset, uintptr_t addr, testword_t xor)
 {
     bool update_stats = false;
@@ -216,9 +239,10 @@ static void common_err(error_type_t type, uintptr_t addr, testword_t good, testw
             display_pinned_message(3, 1,  " Bits in Error - Total:");
             display_pinned_message(4, 1,  " Max Contiguous Errors:");
 
-            display_pinned_message(0, 64, "Test  Errors");
+            display_pinned_message(0, TEST_TABLE_COL(0), "Test  Errors");
+            display_pinned_message(0, TEST_TABLE_COL(NUM_TEST_PATTERNS - 1), "Test  Errors");
             for (int i = 0; i < NUM_TEST_PATTERNS; i++) {
-                display_pinned_message(1 + i, 65, "%2i:", i);
+                display_pinned_message(TEST_TABLE_ROW(i), TEST_TABLE_COL(i) + 1, "%2i:", i);
             }
 
         }
@@ -248,9 +272,7 @@ static void common_err(error_type_t type, uintptr_t addr, testword_t good, testw
                                           error_info.max_run);
 
             for (int i = 0; i < NUM_TEST_PATTERNS; i++) {
-                display_pinned_message(1 + i, 69, "%c%i",
-                                       test_list[i].errors == INT_MAX ? '>' : ' ',
-                                       test_list[i].errors);
+                display_test_errors(i);
             }
 
             display_error_count();
@@ -288,7 +310,13 @@ static void common_err(error_type_t type, uintptr_t addr, testword_t good, testw
             if (type == PARITY_ERROR) {
                 display_scrolled_message(41, "%s", "Parity error detected near this address");
             } else if (type == CECC_ERROR) {
-                display_scrolled_message(41, "%s%2i", "Correctable ECC Error - CH#", ecc_status.channel);
+                if (ecc_status.rank >= 0) {
+                    display_scrolled_message(41, "Corrected ECC - CH#%2i CS%i %7i/h",
+                                             ecc_status.channel, ecc_status.rank, ecc_cecc_rate(ecc_status.channel));
+                } else {
+                    display_scrolled_message(41, "Corrected ECC - CH#%2i     %7i/h",
+                                             ecc_status.channel, ecc_cecc_rate(ecc_status.channel));
+                }
             } else {
 #if TESTWORD_WIDTH > 32
                 display_scrolled_message(41, "%016x  %016x", good, bad);
@@ -343,6 +371,8 @@ void error_init(void)
     error_info.last_xor         = 0;
 
     error_count = 0;
+
+    ecc_stats_reset();
 }
 
 void addr_error(testword_t *addr1, testword_t *addr2, testword_t good, testword_t bad)
@@ -367,6 +397,7 @@ void data_error(testword_t *addr, testword_t good, testword_t bad, bool use_for_
 
 void ecc_error()
 {
+    ecc_stats_record(ecc_status.channel, ecc_status.rank, ecc_status.type == ECC_ERR_CORRECTED, ecc_status.count);
     common_err(CECC_ERROR, ecc_status.addr, 0, 0, false);
     error_update();
 }
@@ -386,10 +417,13 @@ void error_update(void)
         if (error_mode != last_error_mode) {
             common_err(NEW_MODE, 0, 0, 0, false);
         }
+
+        // This may run on the service core while the test CPUs are reporting
+        // errors, so keep it out of common_err().
+        spin_lock(error_mutex);
+
         if (error_mode == ERROR_MODE_SUMMARY && test_list[test_num].errors > 0) {
-            display_pinned_message(1 + test_num, 69, "%c%i",
-                                   test_list[test_num].errors == INT_MAX ? '>' : ' ',
-                                   test_list[test_num].errors);
+            display_test_errors(test_num);
         }
         display_error_count();
 
@@ -406,5 +440,7 @@ void error_update(void)
         if (enable_tty) {
             tty_error_redraw();
         }
+
+        spin_unlock(error_mutex);
     }
 }
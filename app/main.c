@@ -44,10 +44,12 @@
 #include "badram.h"
 #include "config.h"
 #include "display.h"
+#include "envlog.h"
 #include "error.h"
 #include "test.h"
 
 #include "tests.h"
+#include "test_helper.h"
 
 #include "tsc.h"
 
@@ -67,6 +69,10 @@
 
 #define HIGH_LOAD_LIMIT     (VM_PINNED_SIZE << PAGE_SHIFT)
 
+#define REMOTE_PROBE_SIZE   SIZE_C(16,MB) // per CPU core, per window
+
+#define SERVICE_POLL_PERIOD 100           // microseconds
+
 //------------------------------------------------------------------------------
 // Private Variables
 //------------------------------------------------------------------------------
@@ -95,6 +101,13 @@ static size_t           num_mapped_pages = 0;
 
 static int              test_stage = 0;
 
+static bool             measure_remote_bw = false;
+
+static volatile bool    service_stop = false;
+
+static uint64_t         remote_bytes[MAX_CPUS];
+static uint64_t         remote_ticks[MAX_CPUS];
+
 //------------------------------------------------------------------------------
 // Public Variables
 //------------------------------------------------------------------------------
@@ -108,8 +121,17 @@ int         num_enabled_cpus = 1;
 
 int         master_cpu = 0;
 
+int         service_cpu = -1;
+
 barrier_t   *run_barrier = NULL;
 
+int         num_cpu_groups = 1;
+uint8_t     cpu_group[MAX_CPUS];
+uint16_t    cpu_group_index[MAX_CPUS];
+int         cpu_group_size[MAX_CPU_GROUPS];
+int         cpu_group_region[MAX_CPU_GROUPS];
+barrier_t   *group_barrier[MAX_CPU_GROUPS];
+
 spinlock_t  *error_mutex = NULL;
 
 vm_map_t    vm_map[MAX_MEM_SEGMENTS];
@@ -203,6 +225,13 @@ static bool set_load_addr(uintptr_t *load_addr, size_t program_size, uintptr_t l
     return false;
 }
 
+static int time_screen_redraw(void)
+{
+    uint64_t start_time = get_tsc();
+    screen_redraw();
+    return clks_per_msec ? (int)((get_tsc() - start_time) * 1000 / clks_per_msec) : 0;
+}
+
 static void global_init(void)
 {
     floppy_off();
@@ -229,6 +258,8 @@ static void global_init(void)
 
     acpi_init();
 
+    pci_mmcfg_init();
+
     timers_init();
 
     membw_init();
@@ -249,6 +280,9 @@ static void global_init(void)
     if (num_proximity_domains == 0) {
         enable_numa = false;
     }
+    if (num_proximity_domains < 2) {
+        enable_numa_remote = false;
+    }
 
     // At this point we have started reserving physical pages in the memory
     // map for data structures that need to be permanently pinned in place.
@@ -256,6 +290,10 @@ static void global_init(void)
     // boot loader, e.g. the boot parameters, boot command line, and ACPI
     // tables. So do not access those data structures after this point.
 
+    // Allocate the environment log before any USB keyboard search reserves
+    // heap space.
+    envlog_init();
+
     keyboard_init();
 
     display_init();
@@ -272,10 +310,22 @@ static void global_init(void)
         num_available_cpus = 1;
     }
 
+    // Reserve the highest-numbered enabled CPU core as the service core. On
+    // hybrid processors this is normally an E-core.
+    service_cpu = -1;
+    if (enable_service_core) {
+        for (int i = num_available_cpus - 1; i > 0; i--) {
+            if (cpu_state[i] == CPU_STATE_ENABLED) {
+                service_cpu = i;
+                break;
+            }
+        }
+    }
+
     num_enabled_cpus = 0;
     for (int i = 0; i < num_available_cpus; i++) {
         if (cpu_state[i] == CPU_STATE_ENABLED) {
-            if (enable_numa) {
+            if (enable_numa && i != service_cpu) {
                 uint32_t proximity_domain_idx = smp_get_proximity_domain_idx(i);
                 chunk_index[i] = smp_alloc_cpu_in_proximity_domain(proximity_domain_idx);
             } else {
@@ -298,6 +348,24 @@ static void global_init(void)
         post_display_init();
     }
 
+    // The redraws are only timed when the results can be seen, as they can be
+    // slow with an uncached framebuffer.
+    if (enable_trace) {
+        (void)time_screen_redraw();  // warm the glyph cache
+        int uc_redraw_time = time_screen_redraw();
+        if (screen_enable_write_combining()) {
+            trace(0, "screen redraw took %ius, %ius with write-combining", uc_redraw_time, time_screen_redraw());
+        }
+    } else {
+        (void)screen_enable_write_combining();
+    }
+    if (enable_trace) {
+        uint32_t mmcfg_latency = pci_config_latency(true);
+        if (mmcfg_latency != 0) {
+            trace(0, "PCI config read took %ins, %ins with MMCONFIG", pci_config_latency(false), mmcfg_latency);
+        }
+    }
+
     size_t program_size = (_stacks - _start) + BSP_STACK_SIZE + (num_enabled_cpus - 1) * AP_STACK_SIZE;
 
     bool load_addr_ok = set_load_addr(& low_load_addr, program_size,         0x1000,  LOW_LOAD_LIMIT)
@@ -309,11 +377,14 @@ static void global_init(void)
     for (int i = 0; i < pm_map_size; i++) {
         trace(0, "pm %0*x - %0*x", 2*sizeof(uintptr_t), pm_map[i].start, 2*sizeof(uintptr_t), pm_map[i].end);
     }
+    if (num_node_local_bytes > 0) {
+        trace(0, "%ikB excluded for node-local CPU data", (int)(num_node_local_bytes / 1024));
+    }
     if (acpi_config.rsdp_addr != 0) {
         trace(0, "ACPI RSDP (v%u.%u) found in %s at %0*x", acpi_config.ver_maj, acpi_config.ver_min, rsdp_source, 2*sizeof(uintptr_t), acpi_config.rsdp_addr);
         trace(0, "ACPI FADT found at %0*x", 2*sizeof(uintptr_t), acpi_config.fadt_addr);
         trace(0, "ACPI SRAT found at %0*x", 2*sizeof(uintptr_t), acpi_config.srat_addr);
-        //trace(0, "ACPI SLIT found at %0*x", 2*sizeof(uintptr_t), acpi_config.slit_addr);
+        trace(0, "ACPI SLIT found at %0*x", 2*sizeof(uintptr_t), acpi_config.slit_addr);
     }
 
     if (!load_addr_ok) {
@@ -324,6 +395,9 @@ static void global_init(void)
 
     start_barrier = smp_alloc_barrier(1);
     run_barrier   = smp_alloc_barrier(1);
+    for (int i = 0; i < MAX_CPU_GROUPS; i++) {
+        group_barrier[i] = smp_alloc_barrier(1);
+    }
 
     error_mutex   = smp_alloc_mutex();
 
@@ -435,6 +509,60 @@ non_numa_vm_map_entry:
 #endif
 }
 
+static void measure_remote_bandwidth(int my_cpu)
+{
+    // Time a sequential read of the start of this CPU's chunk of each segment
+    // in the current window. All active CPUs do this at the same time, so the
+    // links between proximity domains are loaded as they are by the tests.
+    size_t remaining = REMOTE_PROBE_SIZE / sizeof(testword_t);
+    for (int i = 0; i < vm_map_size && remaining > 0; i++) {
+        testword_t *start, *end;
+        calculate_chunk(&start, &end, my_cpu, i, sizeof(testword_t));
+        if (end < start) {
+            continue;
+        }
+        size_t length = end - start + 1;
+        if (length > remaining) {
+            length = remaining;
+        }
+        uint64_t start_time = get_tsc();
+        for (testword_t *p = start; p < start + length; p++) {
+            read_word(p);
+        }
+        remote_ticks[my_cpu] += get_tsc() - start_time;
+        remote_bytes[my_cpu] += length * sizeof(testword_t);
+        remaining -= length;
+    }
+}
+
+static void report_remote_bandwidth(int pass)
+{
+    // The CPUs in each proximity domain read concurrently, so the bandwidth
+    // between a pair of domains is the sum of the per-CPU bandwidths.
+    for (int from = 0; from < num_proximity_domains; from++) {
+        uint32_t to = smp_get_remote_proximity_domain_idx(from, pass);
+        uint32_t bandwidth = 0;
+        for (int cpu_num = 0; cpu_num < num_available_cpus; cpu_num++) {
+            if (smp_get_proximity_domain_idx(cpu_num) == (uint32_t)from && remote_ticks[cpu_num] > 0) {
+                bandwidth += (remote_bytes[cpu_num] * clks_per_msec) / (remote_ticks[cpu_num] * 1000);
+            }
+        }
+        if (bandwidth > 0) {
+            trace(0, "domain %i -> %i (distance %i): %i MB/s", from, to,
+                  smp_get_proximity_domain_distance(from, to), bandwidth);
+        }
+    }
+}
+
+static void run_service_core(void)
+{
+    while (!service_stop) {
+        do_service_tick();
+        usleep(SERVICE_POLL_PERIOD);
+    }
+    keyboard_service_stop();
+}
+
 static void test_all_windows(int my_cpu)
 {
     bool parallel_test = false;
@@ -443,14 +571,14 @@ static void test_all_windows(int my_cpu)
     if (!dummy_run) {
         if (cpu_mode == PAR && test_list[test_num].cpu_mode == PAR) {
             parallel_test = true;
-            i_am_active = true;
+            i_am_active = (my_cpu != service_cpu);
         }
     }
     if (i_am_master) {
         num_active_cpus = 1;
         if (!dummy_run) {
             if (parallel_test) {
-                num_active_cpus = num_enabled_cpus;
+                num_active_cpus = num_enabled_cpus - (service_cpu >= 0 ? 1 : 0);
                 if(display_mode == DISPLAY_MODE_NA) {
                     display_all_active();
                 }
@@ -472,6 +600,10 @@ static void test_all_windows(int my_cpu)
     // Loop through all possible windows.
     do {
         LONG_BARRIER;
+        if (i_am_master) {
+            // All CPUs have now finished any concurrent tests.
+            num_cpu_groups = 1;
+        }
         if (bail) {
             break;
         }
@@ -516,10 +648,17 @@ static void test_all_windows(int my_cpu)
                 window_end  += VM_WINDOW_SIZE;
             }
             setup_vm_map(window_start, window_end);
+            service_stop = false;
+            if (service_cpu >= 0 && !dummy_run && num_mapped_pages > 0) {
+                keyboard_service_start();
+            }
         }
         SHORT_BARRIER;
 
         if (!i_am_active) {
+            if (my_cpu == service_cpu && !dummy_run && num_mapped_pages > 0) {
+                run_service_core();
+            }
             continue;
         }
 
@@ -538,12 +677,17 @@ static void test_all_windows(int my_cpu)
         } else {
             if (!map_window(vm_map[0].pm_base_addr)) {
                 // Either there is no PAE or we are at the PAE limit.
+                service_stop = true;
                 break;
             }
+            if (measure_remote_bw && parallel_test) {
+                measure_remote_bandwidth(my_cpu);
+            }
             run_test(my_cpu, test_num, test_stage, iterations);
         }
 
         if (i_am_master) {
+            service_stop = true;
             window_num++;
         }
     } while (window_end < pm_map[pm_map_size - 1].end);
@@ -553,7 +697,7 @@ static void select_next_master(void)
 {
     do {
         master_cpu = (master_cpu + 1) % num_available_cpus;
-    } while (cpu_state[master_cpu] == CPU_STATE_DISABLED);
+    } while (cpu_state[master_cpu] == CPU_STATE_DISABLED || master_cpu == service_cpu);
 }
 
 //------------------------------------------------------------------------------
@@ -581,6 +725,7 @@ void main(void)
                 trace(0, "starting other CPUs");
             }
             barrier_reset(start_barrier, num_enabled_cpus);
+            uint64_t start_time = get_tsc();
             int failed = smp_start(cpu_state);
             if (failed) {
                 const char *message = "Failed to start CPU core %i. Press any key to reboot...";
@@ -589,11 +734,14 @@ void main(void)
                 reboot();
             }
             if (enable_trace && num_enabled_cpus > 1) {
-                trace(0, "all other CPUs started");
+                trace(0, "all other CPUs started in %ims", clks_per_msec ? (int)((get_tsc() - start_time) / clks_per_msec) : 0);
                 set_scroll_lock(true);
             }
             init_state = 2;
         } else {
+#if defined(__i386__) || defined(__x86_64__)
+            pat_init();
+#endif
             trace(my_cpu, "AP started");
             cpu_state[my_cpu] = CPU_STATE_RUNNING;
             ap_enumerate(my_cpu);
@@ -601,6 +749,9 @@ void main(void)
                 usleep(100);
             }
         }
+#if defined(__i386__) || defined(__x86_64__)
+        membw_numa_init(my_cpu, start_barrier);
+#endif
     }
 
 #if TEST_INTERRUPT
@@ -624,6 +775,7 @@ void main(void)
                     display_start_run();
                     badram_init();
                     error_init();
+                    envlog_reset();
                 }
             }
             if (start_pass) {
@@ -634,6 +786,11 @@ void main(void)
                 } else {
                     display_start_pass();
                 }
+                measure_remote_bw = enable_numa_remote && !dummy_run;
+                for (int i = 0; i < num_available_cpus; i++) {
+                    remote_bytes[i] = 0;
+                    remote_ticks[i] = 0;
+                }
             }
             if (start_test) {
                 trace(my_cpu, "start test %i", test_num);
@@ -676,6 +833,11 @@ void main(void)
         }
         error_update();
 
+        if (test_list[test_num].enabled && cpu_mode == PAR && test_list[test_num].cpu_mode == PAR) {
+            // The remote bandwidth is measured during the first parallel test of each pass.
+            measure_remote_bw = false;
+        }
+
         if (test_list[test_num].enabled) {
             if (++test_stage < test_list[test_num].stages) {
                 rerun_test = true;
@@ -727,6 +889,13 @@ void main(void)
 
         start_pass = true;
         if (!dummy_run) {
+            if (enable_numa_remote) {
+                report_remote_bandwidth(pass_num - 1);
+            }
+            if (enable_envlog && enable_tty) {
+                envlog_dump(true);
+                tty_full_redraw();
+            }
             display_pass_count(pass_num);
             if (error_count == 0) {
                 display_status("Pass   ");
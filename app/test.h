@@ -42,11 +42,67 @@ extern int num_active_cpus;
  */
 extern int master_cpu;
 
+/**
+ * The CPU core reserved for input polling and display updates, or -1 if
+ * there is none.
+ */
+extern int service_cpu;
+
 /**
  * A barrier used when running tests.
  */
 extern barrier_t *run_barrier;
 
+/**
+ * The maximum number of CPU core groups that can run different tests
+ * concurrently.
+ */
+#define MAX_CPU_GROUPS  4
+
+/**
+ * The number of CPU core groups currently running different tests on
+ * different regions of memory, or 1 if all active cores are running the
+ * same test.
+ */
+extern int num_cpu_groups;
+
+/**
+ * A mapping from a CPU core number to the group it is in, and to its index
+ * within that group. The master CPU core is always the first core of group 0.
+ */
+extern uint8_t cpu_group[MAX_CPUS];
+extern uint16_t cpu_group_index[MAX_CPUS];
+
+/**
+ * The number of CPU cores in each group and the region of memory (as an
+ * index into num_cpu_groups equal parts of each segment) it is testing.
+ */
+extern int cpu_group_size[MAX_CPU_GROUPS];
+extern int cpu_group_region[MAX_CPU_GROUPS];
+
+/**
+ * The barriers used by each group when running tests.
+ */
+extern barrier_t *group_barrier[MAX_CPU_GROUPS];
+
+/**
+ * Returns the barrier used to synchronise the CPU cores running the same
+ * test as my_cpu.
+ */
+static inline barrier_t *test_barrier(int my_cpu)
+{
+    return num_cpu_groups > 1 ? group_barrier[cpu_group[my_cpu]] : run_barrier;
+}
+
+/**
+ * Returns true if my_cpu is responsible for any actions that must only be
+ * performed by one of the CPU cores running the same test as it.
+ */
+static inline bool is_group_leader(int my_cpu)
+{
+    return num_cpu_groups > 1 ? cpu_group_index[my_cpu] == 0 : my_cpu == master_cpu;
+}
+
 /**
  * A mutex used when reporting errors or printing trace information.
  */
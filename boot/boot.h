@@ -88,6 +88,8 @@ extern uint8_t	ap_trampoline[];
 
 extern uint32_t	ap_startup_addr;
 
+extern uint32_t	ap_x2apic_mode;
+
 extern uint8_t	ap_trampoline_end[];
 
 extern uint8_t	_stacks[];
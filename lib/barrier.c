@@ -28,9 +28,8 @@ void barrier_reset(barrier_t *barrier, int num_threads)
     barrier->num_threads = num_threads;
     barrier->count       = num_threads;
 
-    local_flag_t *waiting_flags = local_flags(barrier->flag_num);
     for (int cpu_num = 0; cpu_num < num_available_cpus; cpu_num++) {
-        waiting_flags[cpu_num].flag = false;
+        *local_flag(barrier->flag_num, cpu_num) = false;
     }
 }
 
@@ -39,11 +38,10 @@ void barrier_spin_wait(barrier_t *barrier)
     if (barrier == NULL || barrier->num_threads < 2) {
         return;
     }
-    local_flag_t *waiting_flags = local_flags(barrier->flag_num);
     int my_cpu = smp_my_cpu_num();
-    waiting_flags[my_cpu].flag = true;
+    volatile bool *i_am_blocked = local_flag(barrier->flag_num, my_cpu);
+    *i_am_blocked = true;
     if (__sync_sub_and_fetch(&barrier->count, 1) != 0) {
-        volatile bool *i_am_blocked = &waiting_flags[my_cpu].flag;
         while (*i_am_blocked) {
 #if defined(__x86_64) || defined(__i386__)
             __builtin_ia32_pause();
@@ -67,7 +65,7 @@ void barrier_spin_wait(barrier_t *barrier)
     barrier->count = barrier->num_threads;
     __sync_synchronize();
     for (int cpu_num = 0; cpu_num < num_available_cpus; cpu_num++) {
-        waiting_flags[cpu_num].flag = false;
+        *local_flag(barrier->flag_num, cpu_num) = false;
     }
 }
 
@@ -76,9 +74,8 @@ void barrier_halt_wait(barrier_t *barrier)
     if (barrier == NULL || barrier->num_threads < 2) {
         return;
     }
-    local_flag_t *waiting_flags = local_flags(barrier->flag_num);
     int my_cpu = smp_my_cpu_num();
-    waiting_flags[my_cpu].flag = true;
+    *local_flag(barrier->flag_num, my_cpu) = true;
     //
     // There is a small window of opportunity for the wakeup signal to arrive
     // between us decrementing the barrier count and halting. So code the
@@ -123,10 +120,11 @@ void barrier_halt_wait(barrier_t *barrier)
     // Last one here, so reset the barrier and wake the others.
     barrier->count = barrier->num_threads;
     __sync_synchronize();
-    waiting_flags[my_cpu].flag = false;
+    *local_flag(barrier->flag_num, my_cpu) = false;
     for (int cpu_num = 0; cpu_num < num_available_cpus; cpu_num++) {
-        if (waiting_flags[cpu_num].flag) {
-            waiting_flags[cpu_num].flag = false;
+        volatile bool *waiting = local_flag(barrier->flag_num, cpu_num);
+        if (*waiting) {
+            *waiting = false;
             smp_send_nmi(cpu_num);
         }
     }
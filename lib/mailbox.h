@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: GPL-2.0
+#ifndef MAILBOX_H
+#define MAILBOX_H
+/**
+ * \file
+ *
+ * Provides a lock-free single-producer, multi-consumer message queue.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * The number of messages a mailbox can hold. Must be a power of 2.
+ */
+#define MAILBOX_SIZE    16
+
+/**
+ * A mailbox object. Zero-initialise prior to first use. Only one CPU core
+ * may post to a mailbox, but any CPU core may fetch from it.
+ */
+typedef struct {
+    volatile uint32_t   head;   // written by the producer
+    volatile uint32_t   tail;   // written by the consumers
+    volatile uintptr_t  data[MAILBOX_SIZE];
+} mailbox_t;
+
+/**
+ * Adds a message to the mailbox. Returns false if the mailbox is full.
+ */
+static inline bool mailbox_post(mailbox_t *mailbox, uintptr_t message)
+{
+    uint32_t head = mailbox->head;
+    if (head - mailbox->tail >= MAILBOX_SIZE) {
+        return false;
+    }
+    mailbox->data[head % MAILBOX_SIZE] = message;
+    __sync_synchronize();
+    mailbox->head = head + 1;
+    return true;
+}
+
+/**
+ * Removes the oldest message from the mailbox. Returns false if the mailbox
+ * is empty.
+ */
+static inline bool mailbox_fetch(mailbox_t *mailbox, uintptr_t *message)
+{
+    uint32_t  tail;
+    uintptr_t data;
+    do {
+        tail = mailbox->tail;
+        if (tail == mailbox->head) {
+            return false;
+        }
+        __sync_synchronize();
+        data = mailbox->data[tail % MAILBOX_SIZE];
+    } while (!__sync_bool_compare_and_swap(&mailbox->tail, tail, tail + 1));
+    *message = data;
+    return true;
+}
+
+#endif // MAILBOX_H
@@ -32,6 +32,8 @@
 
 #define HPETSignature   ('H' | ('P' << 8) | ('E' << 16) | ('T' << 24)) // High Precision Event Timer
 
+#define MCFGSignature   ('M' | ('C' << 8) | ('F' << 16) | ('G' << 24)) // PCI Express Memory Mapped Configuration
+
 #define EINJSignature   ('E' | ('I' << 8) | ('N' << 16) | ('J' << 24)) // Error Injection Table
 #define ERSTSignature   ('E' | ('R' << 8) | ('S' << 16) | ('T' << 24)) // Error Record Serialization Table
 #define CPEPSignature   ('C' | ('P' << 8) | ('E' << 16) | ('P' << 24)) // Corrected Platform Error Polling Table
@@ -77,7 +79,7 @@ static const efi_guid_t EFI_ACPI_2_RDSP_GUID = { 0x8868e871, 0xe4f1, 0x11d3, {0x
 
 const char *rsdp_source = "";
 
-acpi_t acpi_config = {0, 0, 0, 0, 0, /*0,*/ 0, 0, 0, false};
+acpi_t acpi_config = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false};
 
 //------------------------------------------------------------------------------
 // Private Functions
@@ -336,5 +338,7 @@ void acpi_init(void)
 
     acpi_config.srat_addr = find_acpi_table(SRATSignature);
 
-    //acpi_config.slit_addr = find_acpi_table(SLITSignature);
+    acpi_config.slit_addr = find_acpi_table(SLITSignature);
+
+    acpi_config.mcfg_addr = find_acpi_table(MCFGSignature);
 }
@@ -28,7 +28,8 @@ typedef struct __attribute__ ((packed)) {
     uintptr_t   fadt_addr;
     uintptr_t   hpet_addr;
     uintptr_t   srat_addr;
-    //uintptr_t   slit_addr;
+    uintptr_t   slit_addr;
+    uintptr_t   mcfg_addr;
     uintptr_t   pm_addr;
     uint8_t     ver_maj;
     uint8_t     ver_min;
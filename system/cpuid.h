@@ -99,13 +99,33 @@ typedef union {
         uint32_t    tm2     : 1;
         uint32_t            : 12;   // ECX feature flags, bit 20
         uint32_t    x2apic  : 1;
-        uint32_t            : 10;   // ECX feature flags, bit 31
+        uint32_t            : 4;
+        uint32_t    xsave   : 1;
+        uint32_t    osxsave : 1;
+        uint32_t    avx     : 1;
+        uint32_t            : 3;    // ECX feature flags, bit 31
         uint32_t            : 29;   // EDX extended feature flags, bit 0
         uint32_t    lm      : 1;
         uint32_t            : 2;    // EDX extended feature flags, bit 31
     };
 } cpuid_feature_flags_t;
 
+typedef union {
+    uint32_t        raw[2];
+    struct {
+        uint32_t            : 5;    // EBX structured extended feature flags, bit 0
+        uint32_t    avx2    : 1;
+        uint32_t            : 3;
+        uint32_t    erms    : 1;
+        uint32_t            : 6;
+        uint32_t    avx512f : 1;
+        uint32_t            : 15;   // EBX structured extended feature flags, bit 31
+        uint32_t            : 4;    // EDX structured extended feature flags, bit 0
+        uint32_t    fsrm    : 1;
+        uint32_t            : 27;   // EDX structured extended feature flags, bit 31
+    };
+} cpuid_struct_flags_t;
+
 #define CPUID_VENDOR_LENGTH     3
 #define CPUID_VENDOR_STR_LENGTH (CPUID_VENDOR_LENGTH * sizeof(uint32_t) + 1)    // includes space for null terminator
 
@@ -139,7 +159,9 @@ typedef union {
 typedef union {
     uint32_t        raw;
     struct {
-        uint32_t    : 1;
+        uint32_t    avx_state       : 1;    // AVX register state enabled in XCR0
+        uint32_t    avx512_state    : 1;    // AVX-512 register state enabled in XCR0
+        uint32_t                    : 30;
     };
 } cpuid_custom_features;
 
@@ -156,9 +178,11 @@ typedef struct {
     uint32_t                max_cpuid;
     uint32_t                max_xcpuid;
     uint32_t                dts_pmp;
+    uint32_t                pm_caps;
     cpuid_version_t         version;
     cpuid_proc_info_t       proc_info;
     cpuid_feature_flags_t   flags;
+    cpuid_struct_flags_t    struct_flags;
     cpuid_vendor_string_t   vendor_id;
     cpuid_brand_string_t    brand_id;
     cpuid_cache_info_t      cache_info;
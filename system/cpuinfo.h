@@ -14,6 +14,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "barrier.h"
+
 /**
  * IMC Definition
  */
@@ -109,6 +111,12 @@ extern int l2_cache;
  */
 extern int l3_cache;
 
+/**
+ * The number of logical processors that share each L3 cache, or 0 if this
+ * is not known.
+ */
+extern int l3_cache_threads;
+
 /**
  * The bandwidth of the L1 cache
  */
@@ -139,9 +147,24 @@ extern uint32_t clks_per_msec;
  */
 void cpuinfo_init(void);
 
+/**
+ * Returns the average clock speed in MHz of the calling CPU core since the
+ * previous call on that core, derived from the APERF/MPERF counters, or 0 if
+ * this is not supported or this is the first call on that core.
+ */
+uint32_t get_effective_cpu_freq(void);
+
 /**
  * Determines the RAM & caches bandwidth and stores it in the exported variables.
  */
 void membw_init(void);
 
+/**
+ * Measures the read bandwidth and latency from each NUMA proximity domain to
+ * the memory in each proximity domain. Must be called by all enabled CPU cores
+ * at the same time, as it synchronises them using the given barrier. If trace
+ * is enabled, the results are displayed as a matrix.
+ */
+void membw_numa_init(int my_cpu, barrier_t *barrier);
+
 #endif // CPUINFO_H
@@ -2,6 +2,7 @@
 // Copyright (C) 2022 Martin Whitaker.
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "boot.h"
 
@@ -11,6 +12,8 @@
 // Variables
 //------------------------------------------------------------------------------
 
+uint8_t *cpu_locals[1 + MAX_APS];
+
 int local_bytes_used = 0;
 
 //------------------------------------------------------------------------------
@@ -11,18 +11,24 @@
  */
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "boot.h"
 
 /**
- * A single thread-local flag. These are spaced out in memory to ensure each
- * flag occupies a different cache line.
+ * The spacing between the thread-local storage areas of CPU cores that are
+ * placed in the same block of memory. This ensures each CPU core's flags
+ * occupy a different cache line (or adjacent-line prefetch pair).
  */
-typedef struct __attribute__((packed)) {
-    bool	flag;
-    uint8_t	spacing[AP_STACK_SIZE - sizeof(bool)];
-} local_flag_t;
+#define LOCALS_STRIDE   128
+
+/**
+ * The thread-local storage area of each CPU core. If an entry is NULL, the
+ * CPU core uses the area reserved at the top of its stack. Otherwise it points
+ * to pinned memory in the CPU core's own proximity domain.
+ */
+extern uint8_t *cpu_locals[1 + MAX_APS];
 
 /**
  * Allocates an array of thread-local flags, one per CPU core, and returns
@@ -33,14 +39,18 @@ typedef struct __attribute__((packed)) {
 int allocate_local_flag(void);
 
 /**
- * Returns a pointer to the previously allocated array of thread-local flags
- * identified by flag_num.
+ * Returns a pointer to the thread-local flag identified by flag_num for the
+ * CPU core whose ordinal number is cpu_num.
  */
-static inline local_flag_t *local_flags(int flag_num)
+static inline volatile bool *local_flag(int flag_num, int cpu_num)
 {
     // The number returned by allocate_local_flag is the byte offset of the
     // flag from the start of the thread-local storage.
-    return (local_flag_t *)(_stacks + BSP_STACK_SIZE - LOCALS_SIZE + flag_num);
+    uint8_t *locals = cpu_locals[cpu_num];
+    if (locals == NULL) {
+        locals = _stacks + BSP_STACK_SIZE - LOCALS_SIZE + cpu_num * AP_STACK_SIZE;
+    }
+    return (volatile bool *)(locals + flag_num);
 }
 
 #endif // CPULOCAL_H
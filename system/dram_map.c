@@ -0,0 +1,296 @@
+// SPDX-License-Identifier: GPL-2.0
+// The method used here is based on the one described in "DRAMA: Exploiting
+// DRAM Addressing for Cross-CPU Attacks" (Pessl et al., USENIX Security 2016),
+// simplified to test single bits, pairs, and triples of address bits.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid.h"
+#include "cpuinfo.h"
+#include "memsize.h"
+#include "tsc.h"
+#include "vmem.h"
+
+#include "dram_map.h"
+
+//------------------------------------------------------------------------------
+// Constants
+//------------------------------------------------------------------------------
+
+#define MIN_BIT             6       // the cache line size
+#define MAX_BIT             39
+
+#define MIN_BLOCK_BITS      26      // we need at least a 64MB block
+
+#define NUM_ACCESSES        32      // per timing measurement
+#define NUM_REPEATS         3       // the fastest is used
+#define NUM_BASES           3       // a majority must agree
+
+#define NUM_CALIBRATIONS    256
+
+#define MAX_BANK_BITS       24
+
+//------------------------------------------------------------------------------
+// Private Variables
+//------------------------------------------------------------------------------
+
+static uint8_t  *block_start;
+static uintptr_t block_size;
+static uintptr_t base_offset[NUM_BASES];
+static uint32_t  threshold;
+
+//------------------------------------------------------------------------------
+// Public Variables
+//------------------------------------------------------------------------------
+
+dram_map_t dram_map = { false, 0, { 0 }, 0, 0 };
+
+//------------------------------------------------------------------------------
+// Private Functions
+//------------------------------------------------------------------------------
+
+static uint32_t access_time(uintptr_t offset1, uintptr_t offset2)
+{
+    uint32_t best = UINT32_MAX;
+    for (int i = 0; i < NUM_REPEATS; i++) {
+        uint64_t start_time = get_tsc();
+        dram_access_pair(block_start + offset1, block_start + offset2, NUM_ACCESSES);
+        uint32_t time = get_tsc() - start_time;
+        if (time < best) {
+            best = time;
+        }
+    }
+    return best;
+}
+
+// Returns true if flipping the address bits in mask gives a different row in
+// the same bank, for the majority of the base addresses.
+static bool is_conflict(uintptr_t mask)
+{
+    int votes = 0;
+    for (int i = 0; i < NUM_BASES; i++) {
+        if (access_time(base_offset[i], base_offset[i] ^ mask) > threshold) {
+            votes++;
+        }
+    }
+    return votes > NUM_BASES / 2;
+}
+
+static bool calibrate(void)
+{
+    static uint32_t times[NUM_CALIBRATIONS];
+
+    uintptr_t state = 0x12345678;
+    for (int i = 0; i < NUM_CALIBRATIONS; i++) {
+        state = state * 1103515245 + 12345;
+        uintptr_t offset1 = (state >> 4) % block_size & ~(uintptr_t)63;
+        state = state * 1103515245 + 12345;
+        uintptr_t offset2 = (state >> 4) % block_size & ~(uintptr_t)63;
+        uint32_t time = access_time(offset1, offset2);
+
+        // Insertion sort.
+        int j = i;
+        while (j > 0 && times[j - 1] > time) {
+            times[j] = times[j - 1];
+            j--;
+        }
+        times[j] = time;
+    }
+
+    // Only a small fraction of random pairs will be in different rows of the
+    // same bank, so the median gives the non-conflict time. Look near the top
+    // for the conflict time, but skip the very top in case of interference.
+    uint32_t median = times[NUM_CALIBRATIONS / 2];
+    uint32_t high   = times[NUM_CALIBRATIONS - 1 - NUM_CALIBRATIONS / 64];
+    if (high * 10 < median * 11) {
+        return false;
+    }
+    threshold = (median + high) / 2;
+    return true;
+}
+
+static inline int parity(uint64_t value)
+{
+    return __builtin_parityll(value);
+}
+
+// Given a set of vectors (bit masks over num_bits bits) spanning the space of
+// bit combinations that do not change the bank, computes a basis for the
+// functions that do, i.e. the masks with even overlap with all the vectors.
+static int orthogonal_basis(uint32_t *vectors, int num_vectors, int num_bits, uint32_t *basis)
+{
+    int pivot_col[MAX_BANK_BITS];
+
+    // Reduce the vectors to reduced row echelon form.
+    int rank = 0;
+    for (int col = 0; col < num_bits && rank < num_vectors; col++) {
+        int row = rank;
+        while (row < num_vectors && !(vectors[row] >> col & 1)) {
+            row++;
+        }
+        if (row == num_vectors) {
+            continue;
+        }
+        uint32_t tmp = vectors[rank]; vectors[rank] = vectors[row]; vectors[row] = tmp;
+        for (int i = 0; i < num_vectors; i++) {
+            if (i != rank && (vectors[i] >> col & 1)) {
+                vectors[i] ^= vectors[rank];
+            }
+        }
+        pivot_col[rank++] = col;
+    }
+
+    // Each free column gives one basis function.
+    int num_basis = 0;
+    for (int col = 0; col < num_bits; col++) {
+        bool is_pivot = false;
+        for (int i = 0; i < rank; i++) {
+            if (pivot_col[i] == col) {
+                is_pivot = true;
+            }
+        }
+        if (is_pivot) {
+            continue;
+        }
+        uint32_t fn = 1 << col;
+        for (int i = 0; i < rank; i++) {
+            if (vectors[i] >> col & 1) {
+                fn |= 1 << pivot_col[i];
+            }
+        }
+        basis[num_basis++] = fn;
+    }
+    return num_basis;
+}
+
+//------------------------------------------------------------------------------
+// Public Functions
+//------------------------------------------------------------------------------
+
+bool dram_access_supported(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    return cpuid_info.flags.cflush && cpuid_info.flags.sse2 && clks_per_msec > 0;
+#else
+    return false;
+#endif
+}
+
+bool dram_map_discover(void *start, size_t size)
+{
+    if (!dram_access_supported()) {
+        return false;
+    }
+
+    // Find the largest naturally aligned power-of-two sized block within the
+    // region, so that any combination of the lower address bits can be
+    // flipped without leaving it.
+    uint64_t phys_start = (uint64_t)page_of(start) << PAGE_SHIFT | ((uintptr_t)start & (PAGE_SIZE - 1));
+    uint64_t phys_end   = phys_start + size;
+    int block_bits = 0;
+    uint64_t block_phys = 0;
+    for (int bits = MIN_BLOCK_BITS; bits <= MAX_BIT; bits++) {
+        uint64_t mask = ((uint64_t)1 << bits) - 1;
+        uint64_t phys = (phys_start + mask) & ~mask;
+        if (phys + mask >= phys_end || phys + mask < phys) {
+            break;
+        }
+        block_bits = bits;
+        block_phys = phys;
+    }
+    if (block_bits == 0) {
+        return false;
+    }
+    block_start = (uint8_t *)start + (block_phys - phys_start);
+    block_size  = (uintptr_t)1 << block_bits;
+
+    for (int i = 0; i < NUM_BASES; i++) {
+        base_offset[i] = (block_size / NUM_BASES) * i & ~(uintptr_t)63;
+    }
+
+    if (!calibrate()) {
+        return false;
+    }
+
+    // A bit that gives a conflict on its own is a row bit that is not used
+    // by any bank function.
+    uint64_t row_bits = 0;
+    for (int bit = MIN_BIT; bit < block_bits; bit++) {
+        if (is_conflict((uintptr_t)1 << bit)) {
+            row_bits |= (uint64_t)1 << bit;
+        }
+    }
+    if (row_bits == 0) {
+        return false;
+    }
+    int row_shift = __builtin_ctzll(row_bits);
+    uintptr_t row_flip = (uintptr_t)1 << row_shift;
+
+    // Of the other bits, those that still give a conflict when combined with
+    // a row bit are column bits. The rest are used by the bank functions.
+    int bank_bit[MAX_BANK_BITS];
+    int num_bank_bits = 0;
+    for (int bit = MIN_BIT; bit < block_bits; bit++) {
+        if (row_bits >> bit & 1) {
+            continue;
+        }
+        if (!is_conflict(((uintptr_t)1 << bit) | row_flip)) {
+            if (num_bank_bits == MAX_BANK_BITS) {
+                return false;
+            }
+            bank_bit[num_bank_bits++] = bit;
+        }
+    }
+
+    // Find the pairs and triples of bank bits that leave the bank unchanged.
+    // These span the space of bank-preserving combinations in most cases.
+    static uint32_t same_bank[MAX_BANK_BITS * MAX_BANK_BITS * MAX_BANK_BITS];
+    int num_same_bank = 0;
+    for (int i = 0; i < num_bank_bits; i++) {
+        uintptr_t mask_i = (uintptr_t)1 << bank_bit[i];
+        for (int j = i + 1; j < num_bank_bits; j++) {
+            uintptr_t mask_j = (uintptr_t)1 << bank_bit[j];
+            if (is_conflict(mask_i | mask_j | row_flip)) {
+                same_bank[num_same_bank++] = 1 << i | 1 << j;
+            }
+            for (int k = j + 1; k < num_bank_bits; k++) {
+                uintptr_t mask_k = (uintptr_t)1 << bank_bit[k];
+                if (is_conflict(mask_i | mask_j | mask_k | row_flip)) {
+                    same_bank[num_same_bank++] = 1 << i | 1 << j | 1 << k;
+                }
+            }
+        }
+    }
+
+    uint32_t basis[MAX_BANK_BITS];
+    int num_fns = orthogonal_basis(same_bank, num_same_bank, num_bank_bits, basis);
+    if (num_fns > MAX_DRAM_BANK_FNS) {
+        return false;
+    }
+
+    dram_map.num_bank_fns = num_fns;
+    for (int i = 0; i < num_fns; i++) {
+        dram_map.bank_fn[i] = 0;
+        for (int j = 0; j < num_bank_bits; j++) {
+            if (basis[i] >> j & 1) {
+                dram_map.bank_fn[i] |= (uint64_t)1 << bank_bit[j];
+            }
+        }
+    }
+    dram_map.row_shift = row_shift;
+    dram_map.max_bit   = block_bits - 1;
+    dram_map.valid     = true;
+
+    return true;
+}
+
+int dram_bank_of(uint64_t addr)
+{
+    int bank = 0;
+    for (int i = 0; i < dram_map.num_bank_fns; i++) {
+        bank |= parity(addr & dram_map.bank_fn[i]) << i;
+    }
+    return bank;
+}
@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: GPL-2.0
+#ifndef DRAM_MAP_H
+#define DRAM_MAP_H
+/**
+ * \file
+ *
+ * Provides discovery of the mapping from physical addresses to DRAM banks
+ * and rows, by timing accesses to pairs of addresses. Two addresses in
+ * different rows of the same bank cannot both have their row open, so
+ * alternating between them (bypassing the cache) is measurably slower than
+ * for any other pair. The bank is assumed to be selected by a set of XOR
+ * functions of the physical address bits, as on all current x86 platforms.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The maximum number of bank address functions that can be discovered.
+ */
+#define MAX_DRAM_BANK_FNS   16
+
+/**
+ * The discovered mapping. Each bank function is a mask of physical address
+ * bits which are XORed together to give one bit of the bank number (which
+ * may include channel, rank, and bank group selection). Address bits from
+ * row_shift upwards that are not in any bank function select the row.
+ */
+typedef struct {
+    bool        valid;
+    int         num_bank_fns;
+    uint64_t    bank_fn[MAX_DRAM_BANK_FNS];
+    int         row_shift;
+    int         max_bit;        // the highest address bit examined
+} dram_map_t;
+
+/**
+ * The result of the last successful call to dram_map_discover().
+ */
+extern dram_map_t dram_map;
+
+/**
+ * Accesses each address in turn, then flushes both from the cache, count
+ * times, so that each access reaches DRAM. Does nothing if the CPU does
+ * not support this.
+ */
+static inline void dram_access_pair(volatile void *addr1, volatile void *addr2, int count)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    for (int i = 0; i < count; i++) {
+        __asm__ __volatile__ (
+            "movl (%0), %%eax   \n\t"
+            "movl (%1), %%eax   \n\t"
+            "clflush (%0)       \n\t"
+            "clflush (%1)       \n\t"
+            "mfence             \n\t"
+            :
+            : "r" (addr1), "r" (addr2)
+            : "eax", "memory"
+        );
+    }
+#else
+    (void)addr1;
+    (void)addr2;
+    (void)count;
+#endif
+}
+
+/**
+ * Returns true if dram_access_pair() and the timing it relies on are
+ * supported on this CPU.
+ */
+bool dram_access_supported(void);
+
+/**
+ * Discovers the DRAM bank functions and row bits by timing accesses within
+ * the given region of memory, which must be contiguous in physical memory.
+ * The address bits examined are limited by the largest naturally aligned
+ * power-of-two sized block within the region. The memory contents are not
+ * changed. Other CPU cores should be idle while this runs. Returns true and
+ * updates dram_map on success.
+ */
+bool dram_map_discover(void *start, size_t size);
+
+/**
+ * Returns the bank number (as defined by the discovered bank functions) of
+ * the given physical address.
+ */
+int dram_bank_of(uint64_t addr);
+
+/**
+ * Returns the row number (as defined by the discovered row bits) of the
+ * given physical address.
+ */
+static inline uint64_t dram_row_of(uint64_t addr)
+{
+    return addr >> dram_map.row_shift;
+}
+
+/**
+ * Returns true if the two physical addresses map to the same DRAM bank.
+ */
+static inline bool dram_same_bank(uint64_t addr1, uint64_t addr2)
+{
+    return dram_bank_of(addr1) == dram_bank_of(addr2);
+}
+
+#endif // DRAM_MAP_H
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cpuinfo.h"
+#include "tsc.h"
+
+#include "ecc.h"
+
+//------------------------------------------------------------------------------
+// Private Variables
+//------------------------------------------------------------------------------
+
+static uint64_t start_time = 0;
+
+//------------------------------------------------------------------------------
+// Public Variables
+//------------------------------------------------------------------------------
+
+ecc_channel_stats_t ecc_channel_stats[MAX_ECC_CHANNELS];
+
+//------------------------------------------------------------------------------
+// Public Functions
+//------------------------------------------------------------------------------
+
+void ecc_stats_reset(void)
+{
+    for (int ch = 0; ch < MAX_ECC_CHANNELS; ch++) {
+        ecc_channel_stats[ch].cecc_count = 0;
+        ecc_channel_stats[ch].uecc_count = 0;
+        for (int rank = 0; rank < MAX_ECC_RANKS; rank++) {
+            ecc_channel_stats[ch].rank_cecc_count[rank] = 0;
+        }
+    }
+    start_time = (clks_per_msec > 0) ? get_tsc() : 0;
+}
+
+void ecc_stats_record(int channel, int rank, bool corrected, uint32_t count)
+{
+    if (channel < 0 || channel >= MAX_ECC_CHANNELS) {
+        return;
+    }
+    ecc_channel_stats_t *stats = &ecc_channel_stats[channel];
+
+    if (!corrected) {
+        stats->uecc_count += count;
+        return;
+    }
+    stats->cecc_count += count;
+    if (rank >= 0 && rank < MAX_ECC_RANKS) {
+        stats->rank_cecc_count[rank] += count;
+    }
+}
+
+uint32_t ecc_cecc_rate(int channel)
+{
+    if (channel < 0 || channel >= MAX_ECC_CHANNELS || clks_per_msec == 0) {
+        return 0;
+    }
+
+    uint64_t elapsed_ms = (get_tsc() - start_time) / clks_per_msec;
+    if (elapsed_ms < 1000) {
+        elapsed_ms = 1000;
+    }
+    return ((uint64_t)ecc_channel_stats[channel].cecc_count * 3600000) / elapsed_ms;
+}
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: GPL-2.0
+#ifndef ECC_H
+#define ECC_H
+/**
+ * \file
+ *
+ * Provides per-channel and per-rank counters for the ECC errors reported
+ * by the memory controller polling code, and the corrected error rate for
+ * each channel.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * The maximum number of memory channels that are tracked.
+ */
+#define MAX_ECC_CHANNELS    16
+
+/**
+ * The maximum number of ranks (chip selects) per channel that are tracked.
+ */
+#define MAX_ECC_RANKS       8
+
+/**
+ * The ECC error counts for a memory channel since the start of the run.
+ */
+typedef struct {
+    uint32_t    cecc_count;
+    uint32_t    uecc_count;
+    uint32_t    rank_cecc_count[MAX_ECC_RANKS];
+} ecc_channel_stats_t;
+
+/**
+ * The ECC error counts for each memory channel.
+ */
+extern ecc_channel_stats_t ecc_channel_stats[MAX_ECC_CHANNELS];
+
+/**
+ * Clears the ECC error counts and restarts the rate measurement.
+ */
+void ecc_stats_reset(void);
+
+/**
+ * Adds count errors of the given type to the counts for the given channel
+ * and rank. rank is negative if it is not known.
+ */
+void ecc_stats_record(int channel, int rank, bool corrected, uint32_t count);
+
+/**
+ * Returns the number of corrected errors per hour seen on the given channel
+ * since the counts were last cleared.
+ */
+uint32_t ecc_cecc_rate(int channel);
+
+#endif // ECC_H
@@ -18,6 +18,9 @@ typedef struct {
     int         segment;
     uintptr_t   start;
     uintptr_t   end;
+    uintptr_t   reserve_start;  // while a reservation is active, allocations are made
+    uintptr_t   reserve_end;    // from reserve_start to reserve_top, otherwise these
+    uintptr_t   reserve_top;    // are all 0
 } heap_t;
 
 //------------------------------------------------------------------------------
@@ -25,8 +28,8 @@ typedef struct {
 //------------------------------------------------------------------------------
 
 static heap_t heaps[HEAP_TYPE_LAST] = {
-    { .segment = -1, .start = 0, .end = 0 },
-    { .segment = -1, .start = 0, .end = 0 }
+    { .segment = -1, .start = 0, .end = 0, .reserve_start = 0, .reserve_end = 0, .reserve_top = 0 },
+    { .segment = -1, .start = 0, .end = 0, .reserve_start = 0, .reserve_end = 0, .reserve_top = 0 }
 };
 
 //------------------------------------------------------------------------------
@@ -38,18 +41,36 @@ static size_t num_pages(size_t size)
     return (size + PAGE_SIZE - 1) >> PAGE_SHIFT;
 }
 
+static uintptr_t heap_top(const heap_t *heap)
+{
+    return heap->reserve_end ? heap->reserve_top : pm_map[heap->segment].end;
+}
+
+static void set_heap_top(heap_t *heap, uintptr_t top)
+{
+    if (heap->reserve_end) {
+        heap->reserve_top = top;
+    } else {
+        pm_map[heap->segment].end = top;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Public Functions
+//------------------------------------------------------------------------------
+
 uintptr_t heap_alloc(heap_type_t heap_id, size_t size, uintptr_t alignment)
 {
-    const heap_t * heap = &heaps[heap_id];
+    heap_t * heap = &heaps[heap_id];
     if (heap->segment < 0) {
         return 0;
     }
-    uintptr_t addr = pm_map[heap->segment].end - num_pages(size);
+    uintptr_t addr = heap_top(heap) - num_pages(size);
     addr &= ~((alignment - 1) >> PAGE_SHIFT);
-    if (addr < heap->start) {
+    if (addr < (heap->reserve_end ? heap->reserve_start : heap->start)) {
         return 0;
     }
-    pm_map[heap->segment].end = addr;
+    set_heap_top(heap, addr);
     return addr << PAGE_SHIFT;
 }
 
@@ -59,20 +80,47 @@ uintptr_t heap_mark(heap_type_t heap_id)
     if (heap->segment < 0) {
         return 0;
     }
-    return pm_map[heap->segment].end;
+    return heap_top(heap);
 }
 
 void heap_rewind(heap_type_t heap_id, uintptr_t mark)
 {
-    const heap_t * heap = &heaps[heap_id];
-    if (heap->segment >= 0 && mark > pm_map[heap->segment].end && mark <= heap->end) {
-        pm_map[heap->segment].end = mark;
+    heap_t * heap = &heaps[heap_id];
+    if (heap->segment >= 0 && mark > heap_top(heap) && mark <= (heap->reserve_end ? heap->reserve_end : heap->end)) {
+        set_heap_top(heap, mark);
     }
 }
-//------------------------------------------------------------------------------
-// Public Functions
-//------------------------------------------------------------------------------
 
+size_t heap_reserve(heap_type_t heap_id, size_t size)
+{
+    heap_t * heap = &heaps[heap_id];
+    if (heap->segment < 0 || heap->reserve_end) {
+        return 0;
+    }
+    uintptr_t top = pm_map[heap->segment].end;
+    uintptr_t num_reserved = num_pages(size);
+    if (num_reserved > top - heap->start) {
+        num_reserved = top - heap->start;
+    }
+    if (num_reserved == 0) {
+        return 0;
+    }
+    pm_map[heap->segment].end = top - num_reserved;
+
+    heap->reserve_start = top - num_reserved;
+    heap->reserve_end   = top;
+    heap->reserve_top   = top;
+
+    return num_reserved << PAGE_SHIFT;
+}
+
+void heap_end_reservation(heap_type_t heap_id)
+{
+    heap_t * heap = &heaps[heap_id];
+    heap->reserve_start = 0;
+    heap->reserve_end   = 0;
+    heap->reserve_top   = 0;
+}
 void heap_init(void)
 {
     // For x86_64 and i386 use the largest 20-bit addressable physical memory segment for the low-memory heap.
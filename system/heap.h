@@ -62,4 +62,29 @@ uintptr_t heap_mark(heap_type_t heap_id);
  */
 void heap_rewind(heap_type_t heap_id, uintptr_t mark);
 
+/**
+ * Sets aside a chunk of physical memory in the given heap, so that it is
+ * excluded from the memory tests straight away. Until heap_end_reservation()
+ * is called, heap_alloc(), heap_mark(), and heap_rewind() operate within the
+ * reserved chunk only. This lets memory be allocated safely while the tests
+ * are running. Any of the chunk left unused when the reservation ends remains
+ * excluded from the memory tests.
+ *
+ * \param heap_id      - the target heap.
+ * \param size         - the requested size in bytes. If less memory is
+ *                       available, what is available is reserved.
+ *
+ * \returns
+ * The number of bytes reserved, which is 0 on failure.
+ */
+size_t heap_reserve(heap_type_t heap_id, size_t size);
+
+/**
+ * Ends the reservation made by heap_reserve(). Subsequent allocations are
+ * made from the remainder of the heap.
+ *
+ * \param heap_id      - the target heap.
+ */
+void heap_end_reservation(heap_type_t heap_id);
+
 #endif // HEAP_H
@@ -25,6 +25,10 @@
 #define SMBAUXSTS   smbusbase + 12
 #define SMBAUXCTL   smbusbase + 13
 
+/* i801 Hosts PCI configuration registers */
+#define SMBHSTCFG               0x40
+#define SMBHSTCFG_SPD_WD        0x10
+
 /* i801 Hosts Status register bits */
 #define SMBHSTSTS_BYTE_DONE     0x80
 #define SMBHSTSTS_INUSE_STS     0x40
@@ -36,6 +40,7 @@
 #define SMBHSTSTS_HOST_BUSY     0x01
 
 /* i801 Hosts Control register bits */
+#define SMBHSTCNT_KILL              0x02
 #define SMBHSTCNT_QUICK             0x00
 #define SMBHSTCNT_BYTE              0x04
 #define SMBHSTCNT_BYTE_DATA         0x08
@@ -46,6 +51,9 @@
 #define SMBHSTCNT_LAST_BYTE         0x20
 #define SMBHSTCNT_START             0x40
 
+/* i801 Hosts Auxiliary Control register bits */
+#define SMBAUXCTL_E32B              0x02
+
 /* AMD-Specific constants */
 #define AMD_INDEX_IO_PORT   0xCD6
 #define AMD_DATA_IO_PORT    0xCD7
@@ -116,4 +124,12 @@ void print_spd_startup_info(void);
 uint8_t get_spd(uint8_t slot_idx, uint16_t spd_adr);
 uint8_t get_spd_hub_register(uint8_t slot_idx, uint8_t spd_hub_adr);
 
+/**
+ * Reads len bytes of SPD data starting at spd_adr into buf using a single
+ * I2C block transaction. The range must not cross an SPD page boundary.
+ * Returns false if the SMBus controller doesn't support block reads or
+ * the transaction failed, in which case the caller should use get_spd().
+ */
+bool get_spd_block(uint8_t slot_idx, uint16_t spd_adr, uint8_t *buf, uint8_t len);
+
 #endif // I2C_X86_H
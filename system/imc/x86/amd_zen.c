@@ -6,6 +6,7 @@
 // Platform-specific code for AMD Zen CPUs
 //
 
+#include "ecc.h"
 #include "error.h"
 
 #include "config.h"
@@ -30,6 +31,7 @@
 
 #define AMD_UMC_OFFSET              0x10
 #define AMD_UMC_VALID_ERROR_BIT     (1 << 31)
+#define AMD_UMC_SYND_VALID_BIT      (1 << 21)
 #define AMD_UMC_ERROR_CECC_BIT      (1 << 14)
 #define AMD_UMC_ERROR_UECC_BIT      (1 << 13)
 #define AMD_UMC_ERR_CNT_EN          (1 << 15)
@@ -40,6 +42,19 @@
 #define ECC_RD_EN (1 << 10)
 #define ECC_WR_EN (1 << 0)
 
+// The last value read from each UMC's ECC error counter. The counters are
+// never cleared, so each poll costs one SMN read per UMC with an error.
+static uint16_t umc_err_cnt[MAX_ECC_CHANNELS];
+
+static uint8_t umc_count(void)
+{
+    if (imc.family == IMC_K19_VRM || imc.family == IMC_K19_RPL || imc.family == IMC_K19_RBT) {
+        return 4;
+    } else {
+        return 2;
+    }
+}
+
 void get_imc_config_amd_zen(void)
 {
     uint32_t smn_reg, offset;
@@ -104,16 +119,8 @@ void get_imc_config_amd_zen(void)
             ecc_status.ecc_enabled = true;
 
             // Number of UMC to init
-            uint8_t umc = 0, umc_max = 0;
-            uint32_t umc_banks_bits = 0;
-
-            if (imc.family == IMC_K19_VRM || imc.family == IMC_K19_RPL || imc.family == IMC_K19_RBT) {
-                umc_max = 4;
-                umc_banks_bits = AMD_MCG_CTL_4_BANKS;
-            } else {
-                umc_max = 2;
-                umc_banks_bits = AMD_MCG_CTL_2_BANKS;
-            }
+            uint8_t umc = 0, umc_max = umc_count();
+            uint32_t umc_banks_bits = (umc_max == 4) ? AMD_MCG_CTL_4_BANKS : AMD_MCG_CTL_2_BANKS;
 
             // Enable ECC reporting
             rdmsr(MSR_IA32_MCG_CTL, regl, regh);
@@ -126,13 +133,12 @@ void get_imc_config_amd_zen(void)
             {
                 rdmsr(mca_ctrl_base + (umc * AMD_UMC_OFFSET), regl, regh);
                 wrmsr(mca_ctrl_base + (umc * AMD_UMC_OFFSET), regl | 1, regh);
-            }
 
-            smn_reg = amd_smn_read(AMD_SMN_UMC_ECC_ERR_CNT_SEL);
-            amd_smn_write(AMD_SMN_UMC_ECC_ERR_CNT_SEL, smn_reg | AMD_UMC_ERR_CNT_EN); // Enable CH0 Error CNT
-
-            smn_reg = amd_smn_read(AMD_SMN_UMC_ECC_ERR_CNT_SEL + AMD_SMN_UMC_CHB_OFFSET);
-            amd_smn_write(AMD_SMN_UMC_ECC_ERR_CNT_SEL + AMD_SMN_UMC_CHB_OFFSET, smn_reg | AMD_UMC_ERR_CNT_EN); // Enable CH1 Error CNT
+                // Enable the UMC error counter and note its starting value
+                smn_reg = amd_smn_read(AMD_SMN_UMC_ECC_ERR_CNT_SEL + (AMD_SMN_UMC_CHB_OFFSET * umc));
+                amd_smn_write(AMD_SMN_UMC_ECC_ERR_CNT_SEL + (AMD_SMN_UMC_CHB_OFFSET * umc), smn_reg | AMD_UMC_ERR_CNT_EN);
+                umc_err_cnt[umc] = amd_smn_read(AMD_SMN_UMC_ECC_ERR_CNT + (AMD_SMN_UMC_CHB_OFFSET * umc)) & 0xFFFF;
+            }
 
             poll_ecc_amd_zen(false); // Clear ECC registers
         }
@@ -142,74 +148,86 @@ void get_imc_config_amd_zen(void)
 
 void poll_ecc_amd_zen(bool report)
 {
-    uint8_t umc = 0, umc_max = 0;
+    uint8_t umc = 0, umc_max = umc_count();
+    uint32_t status_l[MAX_ECC_CHANNELS], status_h[MAX_ECC_CHANNELS];
+    uint32_t pending = 0;
     uint32_t regh, regl;
 
     /* Select UMC MCA MSR base */
     uint32_t mca_status_base = (imc.family >= IMC_K1A_GRG) ? MSR_AMD64_K1A_UMC_MCA_STATUS : MSR_AMD64_K17_UMC_MCA_STATUS;
     uint32_t mca_addr_base   = (imc.family >= IMC_K1A_GRG) ? MSR_AMD64_K1A_UMC_MCA_ADDR   : MSR_AMD64_K17_UMC_MCA_ADDR;
-
-    // Number of UMC to check
-    if (imc.family == IMC_K19_VRM || imc.family == IMC_K19_RPL || imc.family == IMC_K19_RBT) {
-        umc_max = 4;
-    } else {
-        umc_max = 2;
+    uint32_t mca_synd_base   = (imc.family >= IMC_K1A_GRG) ? MSR_AMD64_K1A_UMC_MCA_SYND   : MSR_AMD64_K17_UMC_MCA_SYND;
+
+    // Sweep the status registers of all UMCs first. These are core-local
+    // MSRs, so this is cheap, and in the common case of no errors it avoids
+    // any SMN (PCI configuration) access.
+    for (umc = 0; umc < umc_max; umc++) {
+        rdmsr(mca_status_base + (AMD_UMC_OFFSET * umc), status_l[umc], status_h[umc]);
+        if (status_h[umc] & AMD_UMC_VALID_ERROR_BIT) {
+            pending |= 1 << umc;
+        }
     }
 
-    // Check all UMCs
-    for (umc = 0; umc < umc_max; umc++)
+    // Then handle the UMCs that have logged an error
+    for (umc = 0; pending != 0; umc++, pending >>= 1)
     {
-        // Get Status Register
-        rdmsr(mca_status_base + (AMD_UMC_OFFSET * umc), regl, regh);
-
-        // Check if ECC error happened
-        if (regh & AMD_UMC_VALID_ERROR_BIT) {
-
-            // Check the type or error. Currently, we only report Corrected ECC error
-            // Uncorrected ECC errors are skipped to avoid double detection
-            if (regh & AMD_UMC_ERROR_CECC_BIT) {
-                ecc_status.type = ECC_ERR_CORRECTED;
-            } else if (regh & AMD_UMC_ERROR_UECC_BIT) {
-                ecc_status.type = ECC_ERR_UNCORRECTED;
-            } else {
-                ecc_status.type = ERR_UNKNOWN;
-            }
+        if (!(pending & 1)) {
+            continue;
+        }
+        regh = status_h[umc];
+
+        // Check the type or error. Currently, we only report Corrected ECC error
+        // Uncorrected ECC errors are skipped to avoid double detection
+        if (regh & AMD_UMC_ERROR_CECC_BIT) {
+            ecc_status.type = ECC_ERR_CORRECTED;
+        } else if (regh & AMD_UMC_ERROR_UECC_BIT) {
+            ecc_status.type = ECC_ERR_UNCORRECTED;
+        } else {
+            ecc_status.type = ERR_UNKNOWN;
+        }
 
-            // Populate Channel Number
-            ecc_status.channel = umc;
+        // Populate Channel Number
+        ecc_status.channel = umc;
 
-            // Get Core# associated with the error
-            ecc_status.core = regh & 0x3F;
+        // Get Core# associated with the error
+        ecc_status.core = regh & 0x3F;
 
-            // Get address
-            rdmsr(mca_addr_base + (AMD_UMC_OFFSET * umc), regl, regh);
+        // Get the chip select (rank) from the syndrome, if it is valid
+        ecc_status.rank = -1;
+        if (regh & AMD_UMC_SYND_VALID_BIT) {
+            rdmsr(mca_synd_base + (AMD_UMC_OFFSET * umc), regl, regh);
+            ecc_status.rank = regl & 0x7;
+        }
 
-            ecc_status.addr = (uint64_t)(regh & 0x00FFFFFF) << 32;
-            ecc_status.addr |= regl;
+        // Get address
+        rdmsr(mca_addr_base + (AMD_UMC_OFFSET * umc), regl, regh);
 
-            // Clear Address n-th LSBs according to MSR bit[61:56]
-            ecc_status.addr &= ~0ULL << ((regh >> 24) & 0x3F);
+        ecc_status.addr = (uint64_t)(regh & 0x00FFFFFF) << 32;
+        ecc_status.addr |= regl;
 
-            // Get ECC Error Count
-            ecc_status.count = amd_smn_read(AMD_SMN_UMC_ECC_ERR_CNT + (AMD_SMN_UMC_CHB_OFFSET * umc)) & 0xFFFF;
-            if (!ecc_status.count) ecc_status.count++;
+        // Clear Address n-th LSBs according to MSR bit[61:56]
+        ecc_status.addr &= ~0ULL << ((regh >> 24) & 0x3F);
 
-            // Report error
-            if (report) {
-                ecc_error();
-            }
+        // Get ECC Error Count (the counter is 16 bits wide and wraps)
+        uint16_t err_cnt = amd_smn_read(AMD_SMN_UMC_ECC_ERR_CNT + (AMD_SMN_UMC_CHB_OFFSET * umc)) & 0xFFFF;
+        ecc_status.count = (uint16_t)(err_cnt - umc_err_cnt[umc]);
+        umc_err_cnt[umc] = err_cnt;
+        if (!ecc_status.count) ecc_status.count++;
 
-            // Clear Error
-            rdmsr(mca_status_base + (AMD_UMC_OFFSET * umc), regl, regh);
-            wrmsr(mca_status_base + (AMD_UMC_OFFSET * umc), regl, regh & ~AMD_UMC_VALID_ERROR_BIT);
-            amd_smn_write(AMD_SMN_UMC_ECC_ERR_CNT + (AMD_SMN_UMC_CHB_OFFSET * umc), 0x0);
-
-            // Clear Internal ECC Error status
-            ecc_status.type     = ECC_ERR_NONE;
-            ecc_status.addr     = 0;
-            ecc_status.count    = 0;
-            ecc_status.core     = 0;
-            ecc_status.channel  = 0;
+        // Report error
+        if (report) {
+            ecc_error();
         }
+
+        // Clear Error
+        wrmsr(mca_status_base + (AMD_UMC_OFFSET * umc), status_l[umc], status_h[umc] & ~AMD_UMC_VALID_ERROR_BIT);
+
+        // Clear Internal ECC Error status
+        ecc_status.type     = ECC_ERR_NONE;
+        ecc_status.addr     = 0;
+        ecc_status.count    = 0;
+        ecc_status.core     = 0;
+        ecc_status.channel  = 0;
+        ecc_status.rank     = -1;
     }
 }
@@ -10,6 +10,8 @@
 
 #include "serial.h"
 
+#include "mailbox.h"
+
 #include "keyboard.h"
 #include "config.h"
 
@@ -223,6 +225,16 @@ static const char usb_hid_keymap[] = {
 
 keyboard_types_t keyboard_types = KT_NONE;
 
+//------------------------------------------------------------------------------
+// Private Variables
+//------------------------------------------------------------------------------
+
+static mailbox_t        key_mailbox;
+
+static volatile bool    key_service_active = false;
+
+static bool             usb_search_pending = false;
+
 //------------------------------------------------------------------------------
 // Private Functions
 //------------------------------------------------------------------------------
@@ -350,28 +362,7 @@ static char get_tty_special_key(void)
     }
 }
 
-//------------------------------------------------------------------------------
-// Public Functions
-//------------------------------------------------------------------------------
-
-void keyboard_init(void)
-{
-    if (keyboard_types == KT_NONE) {
-        // No command line option was found, so set the default according to
-        // how we were booted.
-        const boot_params_t *boot_params = (boot_params_t *)boot_params_addr;
-        if (boot_params->efi_info.loader_signature != 0) {
-            keyboard_types = KT_USB|KT_LEGACY;
-        } else {
-            keyboard_types = KT_LEGACY;
-        }
-    }
-    if (keyboard_types & KT_USB) {
-        find_usb_keyboards(keyboard_types == KT_USB);
-    }
-}
-
-char get_key(void)
+static char poll_key(void)
 {
     if (enable_tty) {
         char c = tty_get_char(0);
@@ -388,6 +379,9 @@ char get_key(void)
     }
 
     if (keyboard_types & KT_USB) {
+        if (usb_search_pending) {
+            usb_search_pending = !continue_usb_keyboard_search();
+        }
         uint8_t c = get_usb_keycode();
         if (c > 0 && c < sizeof(usb_hid_keymap)) {
             return usb_hid_keymap[c];
@@ -424,3 +418,62 @@ char get_key(void)
 
     return '\0';
 }
+
+//------------------------------------------------------------------------------
+// Public Functions
+//------------------------------------------------------------------------------
+
+void keyboard_init(void)
+{
+    if (keyboard_types == KT_NONE) {
+        // No command line option was found, so set the default according to
+        // how we were booted.
+        const boot_params_t *boot_params = (boot_params_t *)boot_params_addr;
+        if (boot_params->efi_info.loader_signature != 0) {
+            keyboard_types = KT_USB|KT_LEGACY;
+        } else {
+            keyboard_types = KT_LEGACY;
+        }
+    }
+    if (keyboard_types & KT_USB) {
+        if ((usb_init_options & USB_DEFERRED_INIT) && (~usb_init_options & USB_DEBUG)) {
+            start_usb_keyboard_search();
+            usb_search_pending = true;
+        } else {
+            find_usb_keyboards(keyboard_types == KT_USB);
+        }
+    }
+}
+
+char get_key(void)
+{
+    uintptr_t c;
+    if (mailbox_fetch(&key_mailbox, &c)) {
+        return (char)c;
+    }
+    if (key_service_active) {
+        return '\0';
+    }
+    return poll_key();
+}
+
+void keyboard_service_start(void)
+{
+    key_service_active = true;
+    __sync_synchronize();
+}
+
+void keyboard_service_poll(void)
+{
+    char c = poll_key();
+    if (c != '\0') {
+        // If the mailbox is full, nobody is reading it, so drop the key.
+        (void)mailbox_post(&key_mailbox, c);
+    }
+}
+
+void keyboard_service_stop(void)
+{
+    __sync_synchronize();
+    key_service_active = false;
+}
@@ -48,4 +48,24 @@ void keyboard_init(void);
  */
 char get_key(void);
 
+/**
+ * Hands over keyboard polling to a service CPU core. Until the matching call
+ * of keyboard_service_stop(), get_key() only returns keys that have been
+ * collected by keyboard_service_poll(), so no other CPU core touches the
+ * input devices.
+ */
+void keyboard_service_start(void);
+
+/**
+ * Polls the input devices once and queues any key that has been pressed.
+ * Must only be called by the service CPU core.
+ */
+void keyboard_service_poll(void);
+
+/**
+ * Returns keyboard polling to the callers of get_key(). Keys that have been
+ * queued but not yet read are still returned first.
+ */
+void keyboard_service_stop(void);
+
 #endif // KEYBOARD_H
@@ -37,6 +37,7 @@ const char  *cpu_model = NULL;
 int         l1_cache = 0;
 int         l2_cache = 0;
 int         l3_cache = 0;
+int         l3_cache_threads = 0;
 
 uint32_t    l1_cache_speed  = 0;
 uint32_t    l2_cache_speed  = 0;
@@ -300,6 +301,11 @@ void cpuinfo_init(void)
     determine_cpu_model();
 }
 
+uint32_t get_effective_cpu_freq(void)
+{
+    return 0;
+}
+
 void membw_init(void)
 {
     if(enable_bench) {
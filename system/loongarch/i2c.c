@@ -192,6 +192,16 @@ uint8_t get_spd(uint8_t slot_idx, uint16_t spd_adr)
     return i2c_read_byte(i2c_info.i2c_mc[mc].i2c_base, device_id, spd_adr);
 }
 
+bool get_spd_block(uint8_t slot_idx, uint16_t spd_adr, uint8_t *buf, uint8_t len)
+{
+    (void)slot_idx;
+    (void)spd_adr;
+    (void)buf;
+    (void)len;
+
+    return false;
+}
+
 void print_spd_startup_info(void)
 {
     uint8_t spdidx = 0, spd_line_idx = 0;
@@ -19,7 +19,7 @@
 
 imc_info_t imc = {"UNDEF", 0, 0, 0, 0, 0, 0, 0, 0};
 
-ecc_info_t ecc_status = {false, ECC_ERR_NONE, 0, 0, 0, 0};
+ecc_info_t ecc_status = {false, ECC_ERR_NONE, 0, 0, 0, 0, -1};
 
 // ---------------------
 // -- Public function --
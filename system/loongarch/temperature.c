@@ -52,3 +52,14 @@ int get_ram_temp(uint8_t slot)
 {
     return TEMP_INVALID;
 }
+
+void sample_ram_temp(void)
+{
+}
+
+const ram_temp_history_t *get_ram_temp_history(uint8_t slot)
+{
+    (void)slot;
+
+    return NULL;
+}
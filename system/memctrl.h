@@ -38,6 +38,7 @@ typedef struct __attribute__((packed)) ecc_status {
     uint32_t            count;
     uint16_t            core;
     uint8_t             channel;
+    int8_t              rank;       // -1 if unknown
 } ecc_info_t;
 
 /**
@@ -20,9 +20,12 @@
 #define MSR_IA32_EBL_CR_POWERON         0x2a
 #define MSR_IA32_PLATFORM_INFO          0xce
 #define MSR_IA32_MCG_CTL                0x17b
+#define MSR_IA32_MPERF                  0xe7
+#define MSR_IA32_APERF                  0xe8
 #define MSR_IA32_PERF_STATUS            0x198
 #define MSR_IA32_THERM_STATUS           0x19c
 #define MSR_IA32_TEMPERATURE_TARGET     0x1a2
+#define MSR_IA32_PAT                    0x277
 
 #define MSR_IA32_X2APIC_BASE            0x800
 
@@ -36,9 +39,11 @@
 #define MSR_AMD64_K17_UMC_MCA_CTRL      0xc00020f0
 #define MSR_AMD64_K17_UMC_MCA_STATUS    0xc00020f1
 #define MSR_AMD64_K17_UMC_MCA_ADDR      0xc00020f2
+#define MSR_AMD64_K17_UMC_MCA_SYND      0xc00020f6
 #define MSR_AMD64_K1A_UMC_MCA_CTRL      0xc0002150
 #define MSR_AMD64_K1A_UMC_MCA_STATUS    0xc0002151
 #define MSR_AMD64_K1A_UMC_MCA_ADDR      0xc0002152
+#define MSR_AMD64_K1A_UMC_MCA_SYND      0xc0002156
 #define MSR_AMD64_HW_CONF               0xc0010015
 
 #define MSR_VIA_TEMP_C7                 0x1169
@@ -18,8 +18,12 @@
 #include "boot.h"
 #include "bootparams.h"
 
+#include "acpi.h"
 #include "cpuid.h"
+#include "cpuinfo.h"
 #include "io.h"
+#include "tsc.h"
+#include "vmem.h"
 
 #include "pci.h"
 #include "unistd.h"
@@ -32,6 +36,15 @@
 
 #define PCI_CLASS_BRIDGE_HOST   0x0600
 
+#define MCFG_ENTRIES_OFFSET     44
+
+// Each bus occupies 1MB of the ECAM region. Only the first few buses are
+// mapped, to limit the amount of the device mapping area used. Accesses to
+// other buses use the legacy I/O ports.
+#define MMCFG_MAX_BUSES         16
+
+#define LATENCY_SAMPLES         1000
+
 //------------------------------------------------------------------------------
 // Types
 //------------------------------------------------------------------------------
@@ -42,12 +55,24 @@ typedef enum {
     PCI_CONFIG_TYPE_2     = 2
 } pci_config_type_t;
 
+typedef struct __attribute__ ((packed)) {
+    uint64_t    base_addr;
+    uint16_t    segment;
+    uint8_t     start_bus;
+    uint8_t     end_bus;
+    uint32_t    reserved;
+} mcfg_entry_t;
+
 //------------------------------------------------------------------------------
 // Private Variables
 //------------------------------------------------------------------------------
 
 static pci_config_type_t pci_config_type = PCI_CONFIG_TYPE_NONE;
 
+static uintptr_t mmcfg_base      = 0;   // virtual address of mmcfg_start_bus
+static int       mmcfg_start_bus = 0;
+static int       mmcfg_end_bus   = -1;
+
 //------------------------------------------------------------------------------
 // Private Functions
 //------------------------------------------------------------------------------
@@ -99,6 +124,60 @@ static void probe_config_type(void)
     pci_config_type = PCI_CONFIG_TYPE_NONE;
 }
 
+static inline bool bus_uses_mmcfg(int bus)
+{
+    return bus >= mmcfg_start_bus && bus <= mmcfg_end_bus;
+}
+
+static inline uintptr_t mmcfg_addr(int bus, int dev, int func, int reg)
+{
+    return mmcfg_base
+         | (uintptr_t)(bus - mmcfg_start_bus) << 20
+         | (dev  & 0x1f)  << 15
+         | (func & 0x07)  << 12
+         | (reg  & 0xfff);
+}
+
+// Some AMD processors require memory-mapped configuration accesses to use
+// the EAX register (AMD Family 17h PPR, "MMIO Configuration Coding
+// Requirements"), so the accesses are coded explicitly.
+
+static inline uint8_t mmcfg_read8(uintptr_t addr)
+{
+    uint8_t value;
+    __asm__ __volatile__("movb %1, %0" : "=a" (value) : "m" (*(volatile uint8_t *)addr));
+    return value;
+}
+
+static inline uint16_t mmcfg_read16(uintptr_t addr)
+{
+    uint16_t value;
+    __asm__ __volatile__("movw %1, %0" : "=a" (value) : "m" (*(volatile uint16_t *)addr));
+    return value;
+}
+
+static inline uint32_t mmcfg_read32(uintptr_t addr)
+{
+    uint32_t value;
+    __asm__ __volatile__("movl %1, %0" : "=a" (value) : "m" (*(volatile uint32_t *)addr));
+    return value;
+}
+
+static inline void mmcfg_write8(uintptr_t addr, uint8_t value)
+{
+    __asm__ __volatile__("movb %1, %0" : "=m" (*(volatile uint8_t *)addr) : "a" (value) : "memory");
+}
+
+static inline void mmcfg_write16(uintptr_t addr, uint16_t value)
+{
+    __asm__ __volatile__("movw %1, %0" : "=m" (*(volatile uint16_t *)addr) : "a" (value) : "memory");
+}
+
+static inline void mmcfg_write32(uintptr_t addr, uint32_t value)
+{
+    __asm__ __volatile__("movl %1, %0" : "=m" (*(volatile uint32_t *)addr) : "a" (value) : "memory");
+}
+
 static void set_pci_config1_addr(int bus, int dev, int func, int reg)
 {
     uint32_t addr = 0x80000000
@@ -137,10 +216,93 @@ void pci_init(void)
     }
 }
 
+void pci_mmcfg_init(void)
+{
+    if (acpi_config.mcfg_addr == 0 || pci_config_type != PCI_CONFIG_TYPE_1) {
+        return;
+    }
+
+    rsdt_header_t *mcfg = (rsdt_header_t *)map_region(acpi_config.mcfg_addr, sizeof(rsdt_header_t), true);
+    if (mcfg == NULL) {
+        return;
+    }
+    mcfg = (rsdt_header_t *)map_region(acpi_config.mcfg_addr, mcfg->length, true);
+    if (mcfg == NULL || acpi_checksum(mcfg, mcfg->length) != 0) {
+        return;
+    }
+
+    // Find the entry for segment 0, which is the only one we can address.
+    const mcfg_entry_t *entry = (mcfg_entry_t *)((uint8_t *)mcfg + MCFG_ENTRIES_OFFSET);
+    const mcfg_entry_t *end   = (mcfg_entry_t *)((uint8_t *)mcfg + mcfg->length);
+    while (entry < end && entry->segment != 0) {
+        entry++;
+    }
+    if (entry >= end || entry->start_bus > entry->end_bus) {
+        return;
+    }
+
+    uint64_t base_addr = entry->base_addr + ((uint64_t)entry->start_bus << 20);
+    int      start_bus = entry->start_bus;
+    int      end_bus   = entry->end_bus;
+    if (end_bus - start_bus >= MMCFG_MAX_BUSES) {
+        end_bus = start_bus + MMCFG_MAX_BUSES - 1;
+    }
+    size_t size = (size_t)(end_bus - start_bus + 1) << 20;
+    if (base_addr == 0) {
+        return;
+    }
+#if (ARCH_BITS == 32)
+    if (base_addr + size > 0x100000000ULL) {
+        return;
+    }
+#endif
+
+    uintptr_t base = map_region(base_addr, size, false);
+    if (base == 0) {
+        return;
+    }
+
+    // Check the mapping by comparing the host bridge ID with that read via
+    // the legacy I/O ports before enabling it.
+    uint32_t legacy_id = pci_config_read32(start_bus, 0, 0, PCI_VID_REG);
+    mmcfg_base      = base;
+    mmcfg_start_bus = start_bus;
+    mmcfg_end_bus   = end_bus;
+    if (pci_config_read32(start_bus, 0, 0, PCI_VID_REG) != legacy_id) {
+        mmcfg_end_bus = -1;
+    }
+}
+
+uint32_t pci_config_latency(bool use_mmcfg)
+{
+    if (clks_per_msec == 0 || (use_mmcfg ? mmcfg_end_bus < 0 : pci_config_type == PCI_CONFIG_TYPE_NONE)) {
+        return 0;
+    }
+
+    int bus = use_mmcfg ? mmcfg_start_bus : 0;
+
+    int saved_end_bus = mmcfg_end_bus;
+    if (!use_mmcfg) {
+        mmcfg_end_bus = -1;
+    }
+    uint64_t start_time = get_tsc();
+    for (int i = 0; i < LATENCY_SAMPLES; i++) {
+        (void)pci_config_read32(bus, 0, 0, PCI_VID_REG);
+    }
+    uint64_t elapsed = get_tsc() - start_time;
+    mmcfg_end_bus = saved_end_bus;
+
+    return (elapsed * 1000000) / ((uint64_t)clks_per_msec * LATENCY_SAMPLES);
+}
+
 uint8_t pci_config_read8(int bus, int dev, int func, int reg)
 {
     uint8_t value;
 
+    if (bus_uses_mmcfg(bus)) {
+        return mmcfg_read8(mmcfg_addr(bus, dev, func, reg));
+    }
+
     switch (pci_config_type) {
       case PCI_CONFIG_TYPE_1:
         set_pci_config1_addr(bus, dev, func, reg);
@@ -159,6 +321,10 @@ uint16_t pci_config_read16(int bus, int dev, int func, int reg)
 {
     uint16_t value;
 
+    if (bus_uses_mmcfg(bus)) {
+        return mmcfg_read16(mmcfg_addr(bus, dev, func, reg));
+    }
+
     switch (pci_config_type) {
       case PCI_CONFIG_TYPE_1:
         set_pci_config1_addr(bus, dev, func, reg);
@@ -177,6 +343,10 @@ uint32_t pci_config_read32(int bus, int dev, int func, int reg)
 {
     uint32_t value;
 
+    if (bus_uses_mmcfg(bus)) {
+        return mmcfg_read32(mmcfg_addr(bus, dev, func, reg));
+    }
+
     switch (pci_config_type) {
       case PCI_CONFIG_TYPE_1:
         set_pci_config1_addr(bus, dev, func, reg);
@@ -193,6 +363,11 @@ uint32_t pci_config_read32(int bus, int dev, int func, int reg)
 
 void pci_config_write8(int bus, int dev, int func, int reg, uint8_t value)
 {
+    if (bus_uses_mmcfg(bus)) {
+        mmcfg_write8(mmcfg_addr(bus, dev, func, reg), value);
+        return;
+    }
+
     switch (pci_config_type)
     {
       case PCI_CONFIG_TYPE_1:
@@ -211,6 +386,11 @@ void pci_config_write8(int bus, int dev, int func, int reg, uint8_t value)
 
 void pci_config_write16(int bus, int dev, int func, int reg, uint16_t value)
 {
+    if (bus_uses_mmcfg(bus)) {
+        mmcfg_write16(mmcfg_addr(bus, dev, func, reg), value);
+        return;
+    }
+
     switch (pci_config_type)
     {
       case PCI_CONFIG_TYPE_1:
@@ -229,6 +409,11 @@ void pci_config_write16(int bus, int dev, int func, int reg, uint16_t value)
 
 void pci_config_write32(int bus, int dev, int func, int reg, uint32_t value)
 {
+    if (bus_uses_mmcfg(bus)) {
+        mmcfg_write32(mmcfg_addr(bus, dev, func, reg), value);
+        return;
+    }
+
     switch (pci_config_type)
     {
       case PCI_CONFIG_TYPE_1:
@@ -11,6 +11,7 @@
  * Copyright (C) 2024 Loongson Technology Corporation Limited. All rights reserved.
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #define PCI_MAX_BUS     256
@@ -61,6 +62,21 @@
  */
 void pci_init(void);
 
+/**
+ * Enables memory-mapped (ECAM) access to the PCI configuration space of the
+ * buses described by the ACPI MCFG table, if there is one. Once enabled, the
+ * pci_config_*() functions use it for those buses. Must be called after
+ * acpi_init().
+ */
+void pci_mmcfg_init(void);
+
+/**
+ * Returns the average time in ns taken to read a 32 bit value from the PCI
+ * configuration space, using memory-mapped access if use_mmcfg is true or
+ * the legacy I/O ports if not, or 0 if that method is not available.
+ */
+uint32_t pci_config_latency(bool use_mmcfg);
+
 /**
  * Returns an 8 bit value read from the specified bus+device+function+register
  * address in the PCI configuration address space.
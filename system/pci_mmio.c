@@ -31,6 +31,18 @@ void pci_init(void)
     return;
 }
 
+void pci_mmcfg_init(void)
+{
+    return;
+}
+
+uint32_t pci_config_latency(bool use_mmcfg)
+{
+    (void)use_mmcfg;
+
+    return 0;
+}
+
 uint64_t pci_config_type0_addr(int bus, int dev, int func, int reg)
 {
     uint64_t addr = NB_PCI_MMIO_TYPE0_BASE
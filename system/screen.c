@@ -14,6 +14,14 @@
 
 #include "screen.h"
 
+//------------------------------------------------------------------------------
+// Constants
+//------------------------------------------------------------------------------
+
+#define GLYPH_CACHE_SIZE    (64 * 1024)     // bytes
+
+#define GLYPH_VALID         0x10000         // tag bit marking a cache slot in use
+
 //------------------------------------------------------------------------------
 // Private Types
 //------------------------------------------------------------------------------
@@ -63,10 +71,26 @@ static int lfb_bytes_per_pixel = 0;
 static uintptr_t lfb_base;
 static uintptr_t lfb_stride;
 
+static uintptr_t lfb_map_base = 0;
+static size_t    lfb_map_size = 0;
+
+static bool      lfb_write_combining = false;
+
 static uint32_t lfb_pallete[16];
 
 static lfb_rotate_t lfb_rotate = LFB_TOP_UP;
 
+// Characters are rendered into the glyph cache in the frame buffer's pixel
+// format and orientation, then copied a scanline at a time.
+
+static uintptr_t glyph_cache[GLYPH_CACHE_SIZE / sizeof(uintptr_t)];
+static uint32_t  glyph_tags[GLYPH_CACHE_SIZE / (FONT_WIDTH * FONT_HEIGHT)];
+
+static int glyph_slots     = 0;
+static int glyph_words     = 0;
+static int glyph_rows      = 0;
+static int glyph_row_words = 0;
+
 static uint8_t current_attr = WHITE | BLUE << 4;
 
 //------------------------------------------------------------------------------
@@ -126,128 +150,87 @@ static void vga_put_char(int row, int col, uint8_t ch, uint8_t attr)
     }
 }
 
-static int lfb_offset(int row, int col, int x, int y, int bpp)
+static int glyph_offset(int x, int y)
 {
+    // Returns the position of pixel (x, y) of a character in the glyph cache,
+    // where the glyph is laid out as it appears in the frame buffer.
     switch (lfb_rotate) {
       case LFB_RHS_UP:
-        return (col * FONT_WIDTH  + x) * lfb_stride + ((SCREEN_HEIGHT - row) * FONT_HEIGHT - y - 1) * bpp;
+        return x * FONT_HEIGHT + (FONT_HEIGHT - 1 - y);
       case LFB_LHS_UP:
-        return ((SCREEN_WIDTH - col) * FONT_WIDTH - x - 1) * lfb_stride + (row * FONT_HEIGHT + y) * bpp;
+        return (FONT_WIDTH - 1 - x) * FONT_HEIGHT + y;
       default:
-        return 0;
+        return y * FONT_WIDTH + x;
     }
 }
 
-static void lfb8_put_char(int row, int col, uint8_t ch, uint8_t attr)
+static uintptr_t lfb_char_offset(int row, int col)
 {
-    if (shadow_buffer[row][col].ch   == ch &&
-        shadow_buffer[row][col].attr == attr)
-        return;
-
-    shadow_buffer[row][col].ch   = ch;
-    shadow_buffer[row][col].attr = attr;
-
-    uint8_t fg_colour = attr % 16;
-    uint8_t bg_colour = attr / 16;
-
-    if (lfb_rotate) {
-        for (int y = 0; y < FONT_HEIGHT; y++) {
-            uint8_t font_row = font_data[ch][y];
-            for (int x = 0; x < FONT_WIDTH; x++) {
-                uint8_t *pixel = (uint8_t *)lfb_base + lfb_offset(row, col, x, y, 1);
-                *pixel = font_row & 0x80 ? fg_colour : bg_colour;
-                font_row <<= 1;
-            }
-        }
-    } else {
-        uint8_t *pixel_row = (uint8_t *)lfb_base + row * FONT_HEIGHT * lfb_stride + col * FONT_WIDTH;
-        for (int y = 0; y < FONT_HEIGHT; y++) {
-            uint8_t font_row = font_data[ch][y];
-            for (int x = 0; x < FONT_WIDTH; x++) {
-                pixel_row[x] = font_row & 0x80 ? fg_colour : bg_colour;
-                font_row <<= 1;
-            }
-            pixel_row += lfb_stride;
-        }
-   }
+    // Returns the offset in bytes of the top left corner of a character cell,
+    // as it appears in the frame buffer.
+    switch (lfb_rotate) {
+      case LFB_RHS_UP:
+        return (col * FONT_WIDTH) * lfb_stride + ((SCREEN_HEIGHT - row - 1) * FONT_HEIGHT) * lfb_bytes_per_pixel;
+      case LFB_LHS_UP:
+        return ((SCREEN_WIDTH - col - 1) * FONT_WIDTH) * lfb_stride + (row * FONT_HEIGHT) * lfb_bytes_per_pixel;
+      default:
+        return (row * FONT_HEIGHT) * lfb_stride + (col * FONT_WIDTH) * lfb_bytes_per_pixel;
+    }
 }
 
-static void lfb16_put_char(int row, int col, uint8_t ch, uint8_t attr)
+static void render_glyph(uint8_t *glyph, uint8_t ch, uint8_t attr)
 {
-    if (shadow_buffer[row][col].ch   == ch &&
-        shadow_buffer[row][col].attr == attr)
-        return;
-
-    shadow_buffer[row][col].ch   = ch;
-    shadow_buffer[row][col].attr = attr;
-
-    uint16_t fg_colour = lfb_pallete[attr % 16];
-    uint16_t bg_colour = lfb_pallete[attr / 16];
+    uint32_t fg_colour = attr % 16;
+    uint32_t bg_colour = attr / 16;
+    if (lfb_bytes_per_pixel > 1) {
+        fg_colour = lfb_pallete[fg_colour];
+        bg_colour = lfb_pallete[bg_colour];
+    }
 
-    if (lfb_rotate) {
-        for (int y = 0; y < FONT_HEIGHT; y++) {
-            uint8_t font_row = font_data[ch][y];
-            for (int x = 0; x < FONT_WIDTH; x++) {
-                uint16_t *pixel = (uint16_t *)lfb_base + lfb_offset(row, col, x, y, 1);
-                *pixel = font_row & 0x80 ? fg_colour : bg_colour;
-                font_row <<= 1;
-            }
-        }
-    } else {
-        uint16_t *pixel_row = (uint16_t *)lfb_base + row * FONT_HEIGHT * lfb_stride + col * FONT_WIDTH;
-        for (int y = 0; y < FONT_HEIGHT; y++) {
-            uint8_t font_row = font_data[ch][y];
-            for (int x = 0; x < FONT_WIDTH; x++) {
-                pixel_row[x] = font_row & 0x80 ? fg_colour : bg_colour;
-                font_row <<= 1;
+    for (int y = 0; y < FONT_HEIGHT; y++) {
+        uint8_t font_row = font_data[ch][y];
+        for (int x = 0; x < FONT_WIDTH; x++) {
+            uint8_t *pixel = glyph + glyph_offset(x, y) * lfb_bytes_per_pixel;
+            uint32_t colour = font_row & 0x80 ? fg_colour : bg_colour;
+            for (int i = 0; i < lfb_bytes_per_pixel; i++) {
+                pixel[i] = colour & 0xff; colour >>= 8;
             }
-            pixel_row += lfb_stride;
+            font_row <<= 1;
         }
     }
 }
 
-static void lfb24_put_char(int row, int col, uint8_t ch, uint8_t attr)
+static const uintptr_t *get_glyph(uint8_t ch, uint8_t attr)
 {
+    // The cache is direct mapped. The hash spreads the few attributes in use
+    // across the cache, so the common characters in each colour all fit.
+    uint32_t tag  = GLYPH_VALID | attr << 8 | ch;
+    int      slot = (ch + attr * 97) % glyph_slots;
+
+    uintptr_t *glyph = &glyph_cache[slot * glyph_words];
+    if (glyph_tags[slot] != tag) {
+        render_glyph((uint8_t *)glyph, ch, attr);
+        glyph_tags[slot] = tag;
+    }
+    return glyph;
+}
 
-    if (shadow_buffer[row][col].ch   == ch &&
-        shadow_buffer[row][col].attr == attr)
-        return;
-
-    shadow_buffer[row][col].ch   = ch;
-    shadow_buffer[row][col].attr = attr;
-
-    uint32_t fg_colour = lfb_pallete[attr % 16];
-    uint32_t bg_colour = lfb_pallete[attr / 16];
-
-    if (lfb_rotate) {
-        for (int y = 0; y < FONT_HEIGHT; y++) {
-            uint8_t font_row = font_data[ch][y];
-            for (int x = 0; x < FONT_WIDTH; x++) {
-                uint8_t *pixel = (uint8_t *)lfb_base + lfb_offset(row, col, x, y, 3);
-                uint32_t colour = font_row & 0x80 ? fg_colour : bg_colour;
-                pixel[0] = colour & 0xff; colour >>= 8;
-                pixel[1] = colour & 0xff; colour >>= 8;
-                pixel[2] = colour & 0xff;
-                font_row <<= 1;
-            }
-        }
-    } else {
-        uint8_t *pixel_row = (uint8_t *)lfb_base + row * FONT_HEIGHT * lfb_stride + col * FONT_WIDTH * 3;
-        for (int y = 0; y < FONT_HEIGHT; y++) {
-            uint8_t font_row = font_data[ch][y];
-            for (int x = 0; x < FONT_WIDTH * 3; x += 3) {
-                uint32_t colour = font_row & 0x80 ? fg_colour : bg_colour;
-                pixel_row[x+0] = colour & 0xff; colour >>= 8;
-                pixel_row[x+1] = colour & 0xff; colour >>= 8;
-                pixel_row[x+2] = colour & 0xff;
-                font_row <<= 1;
-            }
-            pixel_row += lfb_stride;
+static void lfb_draw_char(int row, int col, uint8_t ch, uint8_t attr)
+{
+    // Copy the glyph one frame buffer scanline at a time. When the display is
+    // rotated, each scanline holds one column of the character.
+    const uintptr_t *src = get_glyph(ch, attr);
+    uint8_t *dst_row = (uint8_t *)lfb_base + lfb_char_offset(row, col);
+    for (int y = 0; y < glyph_rows; y++) {
+        uintptr_t *dst = (uintptr_t *)dst_row;
+        for (int i = 0; i < glyph_row_words; i++) {
+            dst[i] = *src++;
         }
+        dst_row += lfb_stride;
     }
 }
 
-static void lfb32_put_char(int row, int col, uint8_t ch, uint8_t attr)
+static void lfb_put_char(int row, int col, uint8_t ch, uint8_t attr)
 {
     if (shadow_buffer[row][col].ch   == ch &&
         shadow_buffer[row][col].attr == attr)
@@ -256,29 +239,7 @@ static void lfb32_put_char(int row, int col, uint8_t ch, uint8_t attr)
     shadow_buffer[row][col].ch   = ch;
     shadow_buffer[row][col].attr = attr;
 
-    uint32_t fg_colour = lfb_pallete[attr % 16];
-    uint32_t bg_colour = lfb_pallete[attr / 16];
-
-    if (lfb_rotate) {
-        for (int y = 0; y < FONT_HEIGHT; y++) {
-            uint8_t font_row = font_data[ch][y];
-            for (int x = 0; x < FONT_WIDTH; x++) {
-                uint32_t *pixel = (uint32_t *)lfb_base + lfb_offset(row, col, x, y, 1);
-                *pixel = font_row & 0x80 ? fg_colour : bg_colour;
-                font_row <<= 1;
-            }
-        }
-    } else {
-        uint32_t *pixel_row = (uint32_t *)lfb_base + row * FONT_HEIGHT * lfb_stride + col * FONT_WIDTH;
-        for (int y = 0; y < FONT_HEIGHT; y++) {
-            uint8_t font_row = font_data[ch][y];
-            for (int x = 0; x < FONT_WIDTH; x++) {
-                pixel_row[x] = font_row & 0x80 ? fg_colour : bg_colour;
-                font_row <<= 1;
-            }
-            pixel_row += lfb_stride;
-        }
-    }
+    lfb_draw_char(row, col, ch, attr);
 }
 
 static void (*put_char)(int, int, uint8_t, uint8_t) = vga_put_char;
@@ -310,17 +271,14 @@ void screen_init(void)
 
         if (lfb_depth <= 8) {
             lfb_bytes_per_pixel = 1;
-            put_char = lfb8_put_char;
         } else if (lfb_depth <= 16) {
             lfb_bytes_per_pixel = 2;
-            put_char = lfb16_put_char;
         } else if (lfb_depth <= 24) {
             lfb_bytes_per_pixel = 3;
-            put_char = lfb24_put_char;
         } else {
             lfb_bytes_per_pixel = 4;
-            put_char = lfb32_put_char;
         }
+        put_char = lfb_put_char;
 
         lfb_base = screen_info->lfb_base;
 #if (ARCH_BITS == 64)
@@ -343,6 +301,9 @@ void screen_init(void)
         // The above clipping should guarantee the mapping never fails.
         lfb_base = map_region(lfb_base, lfb_height * lfb_stride, false);
 
+        lfb_map_base = lfb_base;
+        lfb_map_size = lfb_height * lfb_stride;
+
         // Blank the whole framebuffer.
         int pixels_per_word = sizeof(uint32_t) / lfb_bytes_per_pixel;
         uint32_t *line = (uint32_t *)lfb_base;
@@ -373,9 +334,12 @@ void screen_init(void)
             }
         }
 
-        if (lfb_bytes_per_pixel != 3) {
-            lfb_stride /= lfb_bytes_per_pixel;
-        }
+        // Set up the glyph cache. Each glyph row is a whole number of words.
+        int glyph_row_pixels = lfb_rotate ? FONT_HEIGHT : FONT_WIDTH;
+        glyph_rows      = lfb_rotate ? FONT_WIDTH : FONT_HEIGHT;
+        glyph_row_words = glyph_row_pixels * lfb_bytes_per_pixel / sizeof(uintptr_t);
+        glyph_words     = glyph_rows * glyph_row_words;
+        glyph_slots     = GLYPH_CACHE_SIZE / (glyph_words * sizeof(uintptr_t));
 
         // Initialise the pallete.
         uint32_t r_max = (1 << screen_info->red_size  ) - 1;
@@ -392,6 +356,39 @@ void screen_init(void)
     }
 }
 
+bool screen_enable_write_combining(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    if (lfb_map_size == 0) {
+        return false;
+    }
+    pat_init();
+    lfb_write_combining = set_region_write_combining(lfb_map_base, lfb_map_size);
+#endif
+    return lfb_write_combining;
+}
+
+void screen_redraw(void)
+{
+    if (put_char != lfb_put_char) {
+        return;
+    }
+    for (int row = 0; row < SCREEN_HEIGHT; row++) {
+        for (int col = 0; col < SCREEN_WIDTH; col++) {
+            lfb_draw_char(row, col, shadow_buffer[row][col].ch, shadow_buffer[row][col].attr);
+        }
+    }
+    screen_flush();
+}
+
+void screen_flush(void)
+{
+    if (lfb_write_combining) {
+        // Drain the write-combining buffers.
+        __sync_synchronize();
+    }
+}
+
 void set_foreground_colour(screen_colour_t colour)
 {
     current_attr = (current_attr & 0xf0) | (colour & 0x0f);
@@ -409,6 +406,7 @@ void clear_screen(void)
             put_char(row, col, ' ', current_attr);
         }
     }
+    screen_flush();
 }
 
 void clear_screen_region(int start_row, int start_col, int end_row, int end_col)
@@ -427,6 +425,7 @@ void clear_screen_region(int start_row, int start_col, int end_row, int end_col)
             put_char(row, col, ' ', current_attr);
         }
     }
+    screen_flush();
 }
 
 void scroll_screen_region(int start_row, int start_col, int end_row, int end_col)
@@ -449,6 +448,7 @@ void scroll_screen_region(int start_row, int start_col, int end_row, int end_col
             }
         }
     }
+    screen_flush();
 }
 
 void save_screen_region(int start_row, int start_col, int end_row, int end_col, uint16_t buffer[])
@@ -479,6 +479,7 @@ void restore_screen_region(int start_row, int start_col, int end_row, int end_co
             put_value(row, col, *src++);
         }
     }
+    screen_flush();
 }
 
 void print_char(int row, int col, char ch)
@@ -11,6 +11,7 @@
  * Copyright (C) 2020-2024 Martin Whitaker.
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 
 /**
@@ -74,6 +75,23 @@ extern vga_buffer_t shadow_buffer;
  */
 void screen_init(void);
 
+/**
+ * Maps the frame buffer (if used) as write-combining memory. The caller must
+ * call pat_init() on each of the other CPU cores before they write to the
+ * screen. Returns true if write-combining was enabled.
+ */
+bool screen_enable_write_combining(void);
+
+/**
+ * Redraws every character on the screen from the shadow buffer.
+ */
+void screen_redraw(void);
+
+/**
+ * Ensures all previous writes to the screen have reached the frame buffer.
+ */
+void screen_flush(void);
+
 /**
  * Set the foreground colour used for subsequent drawing operations.
  */
@@ -162,6 +162,11 @@ void tty_init(void)
     tty_disable_cursor();
 }
 
+void tty_write(const char *p)
+{
+    serial_echo_print(p);
+}
+
 void tty_send_region(int start_row, int start_col, int end_row, int end_col)
 {
     char p[SCREEN_WIDTH+1];
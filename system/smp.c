@@ -36,6 +36,7 @@
 #include "vmem.h"
 #include "pmem.h"
 
+#include "cpulocal.h"
 #include "smp.h"
 
 #define SEQUENTIAL_AP_START         0
@@ -119,12 +120,32 @@
 #define SRAT_MAF_ENABLED               1
 #define SRAT_PXAAF_ENABLED             1
 
+// The highest APIC ID that can be used as an 8-bit xAPIC destination (0xff
+// is the broadcast ID)
+
+#define XAPIC_MAX_APIC_ID           0xfe
+
+// The size of the hash table used to map APIC IDs to CPU numbers. This
+// must be a power of 2.
+
+#define APIC_ID_HASH_SIZE           (2 * MAX_CPUS)
+
 // Private memory heap used for AP trampoline and synchronisation objects
 
 #define HEAP_BASE_ADDR              (smp_heap_page << PAGE_SHIFT)
 
 #define AP_TRAMPOLINE_PAGE          (smp_heap_page)
 
+// The alignment of synchronisation objects, chosen so that no two objects
+// share a cache line.
+
+#define SYNC_OBJECT_ALIGN           64
+
+// The maximum number of proximity domains for which we record the SLIT
+// distances.
+
+#define MAX_SLIT_DOMAINS            64
+
 //------------------------------------------------------------------------------
 // Types
 //------------------------------------------------------------------------------
@@ -318,6 +339,8 @@ static uint32_t          cpu_num_to_proximity_domain_idx[MAX_CPUS];
 
 static uint32_t          cpu_num_to_apic_id[MAX_CPUS];
 
+static uint16_t          apic_id_to_cpu_num[APIC_ID_HASH_SIZE];   // CPU number + 1, or 0 if unused
+
 static memory_affinity_t memory_affinity_ranges[MAX_APIC_IDS];
 
 static uint32_t          proximity_domains[MAX_PROXIMITY_DOMAINS];
@@ -325,6 +348,10 @@ static uint32_t          proximity_domains[MAX_PROXIMITY_DOMAINS];
 static uint16_t           cpus_in_proximity_domain[MAX_PROXIMITY_DOMAINS];
 uint16_t                  used_cpus_in_proximity_domain[MAX_PROXIMITY_DOMAINS];
 
+static uint8_t           proximity_domain_distance[MAX_SLIT_DOMAINS][MAX_SLIT_DOMAINS];
+
+static uint16_t          remote_domain_offsets[MAX_PROXIMITY_DOMAINS];
+
 static uintptr_t         smp_heap_page = 0;
 
 static uintptr_t         alloc_addr = 0;
@@ -338,6 +365,7 @@ static bool              apic_x2apic = false;
 int     num_available_cpus = 1;  // There is always at least one CPU, the BSP
 int     num_memory_affinity_ranges = 0;
 int     num_proximity_domains = 0;
+size_t  num_node_local_bytes = 0;
 bool    map_numa_memory_range = false;
 uint8_t highest_map_bit = 0;
 
@@ -513,6 +541,24 @@ static bool find_cpus_in_floating_mp_struct(void)
 }
 #endif
 
+static void add_madt_cpu(uint32_t apic_id, int *found_cpus)
+{
+    // Some firmware lists CPUs in both the xAPIC and x2APIC entries.
+    for (int i = 0; i < *found_cpus && i < MAX_CPUS; i++) {
+        if (cpu_num_to_apic_id[i] == apic_id) {
+            return;
+        }
+    }
+    if (num_available_cpus < MAX_CPUS) {
+        cpu_num_to_apic_id[*found_cpus] = apic_id;
+        // The first CPU is the BSP, don't increment.
+        if (*found_cpus > 0) {
+            num_available_cpus++;
+        }
+    }
+    (*found_cpus)++;
+}
+
 static bool find_cpus_in_madt(void)
 {
     if (acpi_config.madt_addr == 0) {
@@ -543,15 +589,8 @@ static bool find_cpus_in_madt(void)
                 return false;
             }
             madt_processor_entry_t *entry = (madt_processor_entry_t *)tab_entry_ptr;
-            if (entry->flags & (MADT_PF_ENABLED|MADT_PF_ONLINE_CAPABLE)) {
-                if (num_available_cpus < MAX_CPUS) {
-                    cpu_num_to_apic_id[found_cpus] = entry->apic_id;
-                    // The first CPU is the BSP, don't increment.
-                    if (found_cpus > 0) {
-                        num_available_cpus++;
-                    }
-                }
-                found_cpus++;
+            if (entry->flags & (MADT_PF_ENABLED|MADT_PF_ONLINE_CAPABLE) && entry->apic_id != 0xff) {
+                add_madt_cpu(entry->apic_id, &found_cpus);
             }
         }
         else if (entry_header->type == MADT_PROCESSOR_X2APIC) {
@@ -559,15 +598,8 @@ static bool find_cpus_in_madt(void)
                 return false;
             }
             madt_processor_x2apic_entry_t *entry = (madt_processor_x2apic_entry_t *)tab_entry_ptr;
-            if (entry->flags & MADT_PF_ENABLED) {
-                if (num_available_cpus < MAX_CPUS) {
-                    cpu_num_to_apic_id[found_cpus] = entry->apic_id;
-                    // The first CPU is the BSP, don't increment.
-                    if (found_cpus > 0) {
-                        num_available_cpus++;
-                    }
-                }
-                found_cpus++;
+            if (entry->flags & (MADT_PF_ENABLED|MADT_PF_ONLINE_CAPABLE) && entry->apic_id != 0xffffffff) {
+                add_madt_cpu(entry->apic_id, &found_cpus);
             }
         }
         else if (entry_header->type == MADT_LAPIC_ADDR) {
@@ -581,14 +613,7 @@ static bool find_cpus_in_madt(void)
         if (entry_header->type == MADT_CORE_PIC) {
             madt_processor_entry_t *entry = (madt_processor_entry_t *)tab_entry_ptr;
             if (entry->flags & (MADT_PF_ENABLED|MADT_PF_ONLINE_CAPABLE)) {
-                if (num_available_cpus < MAX_CPUS) {
-                    cpu_num_to_apic_id[found_cpus] = entry->core_id;
-                    // The first CPU is the BSP, don't increment.
-                    if (found_cpus > 0) {
-                        num_available_cpus++;
-                    }
-                }
-                found_cpus++;
+                add_madt_cpu(entry->core_id, &found_cpus);
             }
         }
 #endif
@@ -730,12 +755,10 @@ find_proximity_domain:
                     }
                 }
 
-                if (found2 == -1) {
-                    // We've found an affinity entry whose APIC ID we don't know about.
-                    return false;
+                // Ignore affinity entries for CPUs we aren't using (e.g. beyond MAX_CPUS).
+                if (found2 != -1) {
+                    cpu_num_to_proximity_domain_idx[found2] = (uint32_t)found1;
                 }
-
-                cpu_num_to_proximity_domain_idx[found2] = (uint32_t)found1;
             }
         }
         else if (entry_header->type == SRAT_PROCESSOR_X2APIC_AFFINITY) {
@@ -754,16 +777,22 @@ find_proximity_domain:
     return true;
 }
 
-#if 0
 static bool parse_slit(uintptr_t slit_addr)
 {
     // SLIT is a simple table.
+    if (slit_addr == 0) {
+        return false;
+    }
 
     // SLIT Header is identical to RSDP Header
-    rsdt_header_t *slit = (rsdt_header_t *)slit_addr;
+    rsdt_header_t *slit = (rsdt_header_t *)map_region(slit_addr, sizeof(rsdt_header_t), true);
+    if (slit == NULL) return false;
+
+    slit = (rsdt_header_t *)map_region(slit_addr, slit->length, true);
+    if (slit == NULL) return false;
 
     // Validate SLIT
-    if (slit == NULL || acpi_checksum(slit, slit->length) != 0) {
+    if (acpi_checksum(slit, slit->length) != 0) {
         return false;
     }
     // A SLIT shall always contain at least one byte beyond the header and the number of localities.
@@ -779,9 +808,55 @@ static bool parse_slit(uintptr_t slit_addr)
         return false;
     }
 
+    // The localities are numbered by SRAT proximity domain.
+    if (num_proximity_domains > MAX_SLIT_DOMAINS) {
+        return false;
+    }
+    for (int i = 0; i < num_proximity_domains; i++) {
+        if (proximity_domains[i] >= localities) {
+            return false;
+        }
+    }
+    uint8_t *distances = (uint8_t *)slit + sizeof(*slit) + sizeof(uint64_t);
+    for (int i = 0; i < num_proximity_domains; i++) {
+        for (int j = 0; j < num_proximity_domains; j++) {
+            proximity_domain_distance[i][j] = distances[proximity_domains[i] * localities + proximity_domains[j]];
+        }
+    }
+
     return true;
 }
-#endif
+
+static uint32_t remote_offset_distance(int offset)
+{
+    if (num_proximity_domains > MAX_SLIT_DOMAINS) {
+        return 0;
+    }
+    uint32_t distance = 0;
+    for (int i = 0; i < num_proximity_domains; i++) {
+        distance += proximity_domain_distance[i][(i + offset) % num_proximity_domains];
+    }
+    return distance;
+}
+
+static void order_remote_proximity_domains(void)
+{
+    // For remote NUMA testing, each proximity domain tests the memory of the
+    // domain a fixed offset away, so every domain is tested by exactly one
+    // other domain on each pass. Sort the offsets by the total SLIT distance
+    // they span, so the passes work outwards from the nearest pairings. If
+    // there is no SLIT, all distances are 0 and the offsets stay in order.
+    int num_offsets = 0;
+    for (int offset = 1; offset < num_proximity_domains; offset++) {
+        uint32_t distance = remote_offset_distance(offset);
+        int i = num_offsets++;
+        while (i > 0 && remote_offset_distance(remote_domain_offsets[i - 1]) > distance) {
+            remote_domain_offsets[i] = remote_domain_offsets[i - 1];
+            i--;
+        }
+        remote_domain_offsets[i] = offset;
+    }
+}
 
 static inline void send_ipi(int apic_id, int trigger __attribute__((unused)), int level __attribute__((unused)), int mode, uint8_t vector)
 {
@@ -846,6 +921,22 @@ static uint32_t read_apic_esr(bool is_p5)
     return apic_read(APIC_REG_ESR);
 }
 
+static bool use_long_ipi_delays(void)
+{
+    if ((cpuid_info.vendor_id.str[0] == 'G' && cpuid_info.version.family == 6)      // Intel P6 or later
+    ||  (cpuid_info.vendor_id.str[0] == 'A' && cpuid_info.version.family >= 15)) {  // AMD Hammer or later
+        return false;
+    }
+    return true;
+}
+
+static bool apic_is_p5(void)
+{
+    uint32_t apic_ver = apic_read(APIC_REG_VER);
+    uint32_t max_lvt = (apic_ver >> 16) & 0x7f;
+    return (max_lvt == 3);
+}
+
 static bool start_cpu(int cpu_num)
 {
     // This is based on the method used in Linux 5.14.
@@ -853,15 +944,9 @@ static bool start_cpu(int cpu_num)
 
     int apic_id = cpu_num_to_apic_id[cpu_num];
 
-    uint32_t apic_ver = apic_read(APIC_REG_VER);
-    uint32_t max_lvt = (apic_ver >> 16) & 0x7f;
-    bool is_p5 = (max_lvt == 3);
+    bool is_p5 = apic_is_p5();
 
-    bool use_long_delays = true;
-    if ((cpuid_info.vendor_id.str[0] == 'G' && cpuid_info.version.family == 6)      // Intel P6 or later
-    ||  (cpuid_info.vendor_id.str[0] == 'A' && cpuid_info.version.family >= 15)) {  // AMD Hammer or later
-        use_long_delays = false;
-    }
+    bool use_long_delays = use_long_ipi_delays();
 
     // Clear APIC errors.
     (void)read_apic_esr(is_p5);
@@ -899,6 +984,64 @@ static bool start_cpu(int cpu_num)
 
     return true;
 }
+
+static bool start_cpus_in_parallel(cpu_state_t cpu_state[MAX_CPUS])
+{
+    // This follows the same sequence as start_cpu(), but sends each IPI to
+    // all the enabled APs before moving on to the next step. The IPIs are
+    // still sent individually, rather than using the "all excluding self"
+    // shorthand, so that CPUs the user has disabled, or that we don't know
+    // about, are left alone.
+
+    bool is_p5 = apic_is_p5();
+
+    bool use_long_delays = use_long_ipi_delays();
+
+    // Clear APIC errors.
+    (void)read_apic_esr(is_p5);
+
+    // Pulse the INIT IPI.
+    for (int cpu_num = 1; cpu_num < num_available_cpus; cpu_num++) {
+        if (cpu_state[cpu_num] != CPU_STATE_ENABLED) continue;
+        if (!send_ipi_and_wait(cpu_num_to_apic_id[cpu_num], APIC_TRIGGER_LEVEL, 1, APIC_DELMODE_INIT, 0, 0)) {
+            return false;
+        }
+    }
+    if (use_long_delays) {
+        usleep(10*1000);  // 10ms
+    }
+    for (int cpu_num = 1; cpu_num < num_available_cpus; cpu_num++) {
+        if (cpu_state[cpu_num] != CPU_STATE_ENABLED) continue;
+        if (!send_ipi_and_wait(cpu_num_to_apic_id[cpu_num], APIC_TRIGGER_LEVEL, 0, APIC_DELMODE_INIT, 0, 0)) {
+            return false;
+        }
+    }
+
+    // Send two STARTUP_IPIs.
+    for (int num_sipi = 0; num_sipi < 2; num_sipi++) {
+        // Clear APIC errors.
+        (void)read_apic_esr(is_p5);
+
+        // Send the STARTUP IPI.
+        for (int cpu_num = 1; cpu_num < num_available_cpus; cpu_num++) {
+            if (cpu_state[cpu_num] != CPU_STATE_ENABLED) continue;
+            if (!send_ipi_and_wait(cpu_num_to_apic_id[cpu_num], 0, 0, APIC_DELMODE_STARTUP, AP_TRAMPOLINE_PAGE, 0)) {
+                return false;
+            }
+        }
+
+        // Give the other CPUs some time to accept the IPI.
+        usleep(use_long_delays ? 300 + 200 : 10 + 10);
+
+        // Check the IPIs were accepted.
+        uint32_t status = read_apic_esr(is_p5) & 0xef;
+        if (status != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
 #elif defined(__loongarch_lp64)
 static bool start_cpu(int cpu_num)
 {
@@ -1002,6 +1145,156 @@ void check_if_needs_to_map(void)
 }
 #endif
 
+static void move_bsp_to_cpu_0(void)
+{
+    // The MADT is expected to list the BSP first, but that isn't guaranteed,
+    // particularly when x2APIC entries are present.
+    uint32_t bsp_apic_id = my_apic_id();
+    for (int i = 1; i < num_available_cpus; i++) {
+        if (cpu_num_to_apic_id[i] == bsp_apic_id) {
+            cpu_num_to_apic_id[i] = cpu_num_to_apic_id[0];
+            break;
+        }
+    }
+    cpu_num_to_apic_id[0] = bsp_apic_id;
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+static void select_apic_mode(void)
+{
+    uint32_t max_apic_id = 0;
+    for (int i = 0; i < num_available_cpus; i++) {
+        if (cpu_num_to_apic_id[i] > max_apic_id) {
+            max_apic_id = cpu_num_to_apic_id[i];
+        }
+    }
+
+    // If any CPU can't be addressed by an 8-bit xAPIC destination, switch to
+    // x2APIC mode if we can. The APs are switched in the AP trampoline.
+    if (!apic_x2apic && max_apic_id > XAPIC_MAX_APIC_ID && cpuid_info.flags.x2apic) {
+        uint32_t msrl, msrh;
+        rdmsr(MSR_IA32_APIC_BASE, msrl, msrh);
+        if (msrl & IA32_APIC_ENABLED) {
+            wrmsr(MSR_IA32_APIC_BASE, msrl | IA32_APIC_EXTENDED, msrh);
+            apic_x2apic = true;
+        }
+    }
+    ap_x2apic_mode = apic_x2apic;
+
+    if (apic_x2apic) {
+        return;
+    }
+
+    // Otherwise drop the CPUs we can't address, rather than letting the
+    // truncated destination ID select the wrong CPU.
+    int num_cpus = 1;
+    for (int i = 1; i < num_available_cpus; i++) {
+        if (cpu_num_to_apic_id[i] <= XAPIC_MAX_APIC_ID) {
+            cpu_num_to_apic_id[num_cpus++] = cpu_num_to_apic_id[i];
+        }
+    }
+    num_available_cpus = num_cpus;
+}
+#endif
+
+static void build_apic_id_hash(void)
+{
+    for (int i = 0; i < APIC_ID_HASH_SIZE; i++) {
+        apic_id_to_cpu_num[i] = 0;
+    }
+    for (int cpu_num = 0; cpu_num < num_available_cpus; cpu_num++) {
+        int i = cpu_num_to_apic_id[cpu_num] & (APIC_ID_HASH_SIZE - 1);
+        while (apic_id_to_cpu_num[i] != 0) {
+            i = (i + 1) & (APIC_ID_HASH_SIZE - 1);
+        }
+        apic_id_to_cpu_num[i] = cpu_num + 1;
+    }
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+static uintptr_t alloc_in_proximity_domain(uint32_t proximity_domain_idx, size_t size)
+{
+    // Take whole 2MB pages from the top of the highest free memory segment
+    // that lies in the proximity domain. This ensures the memory we use never
+    // shares a large page mapping with memory that is under test.
+    uintptr_t vm_page_pages = VM_PAGE_SIZE >> PAGE_SHIFT;
+    uintptr_t num_pages = ((size + VM_PAGE_SIZE - 1) >> VM_PAGE_SHIFT) * vm_page_pages;
+    for (int i = pm_map_size - 1; i >= 0; i--) {
+        uintptr_t end_page = pm_map[i].end & ~(vm_page_pages - 1);
+        if (end_page < pm_map[i].start + num_pages) {
+            continue;
+        }
+#ifdef __i386__
+        // We can only map memory below 4GB.
+        if (end_page > PAGE_C(4,GB)) {
+            continue;
+        }
+#endif
+        uintptr_t start_page = end_page - num_pages;
+        uint64_t start = (uint64_t)start_page << PAGE_SHIFT;
+        uint64_t end   = (uint64_t)end_page   << PAGE_SHIFT;
+        for (int j = 0; j < num_memory_affinity_ranges; j++) {
+            if (memory_affinity_ranges[j].proximity_domain_idx == proximity_domain_idx
+            &&  memory_affinity_ranges[j].start <= start && memory_affinity_ranges[j].end >= end) {
+                uintptr_t addr = map_region(start_page << PAGE_SHIFT, num_pages << PAGE_SHIFT, false);
+                if (addr == 0) {
+                    return 0;
+                }
+                // The memory is taken out of testing for the whole run.
+                pm_map[i].end = start_page;
+                num_node_local_bytes += num_pages << PAGE_SHIFT;
+                return addr;
+            }
+        }
+    }
+    return 0;
+}
+
+static void place_cpu_locals_in_proximity_domains(void)
+{
+    // Give each CPU core thread-local storage in memory attached to its own
+    // proximity domain, so spinning on a barrier flag doesn't cause traffic
+    // between nodes. If no memory can be found in a proximity domain, its CPU
+    // cores keep using the storage reserved at the top of their stacks.
+    for (int domain_idx = 0; domain_idx < num_proximity_domains; domain_idx++) {
+        if (cpus_in_proximity_domain[domain_idx] == 0) {
+            continue;
+        }
+        size_t size = cpus_in_proximity_domain[domain_idx] * LOCALS_STRIDE;
+        uint8_t *locals = (uint8_t *)alloc_in_proximity_domain(domain_idx, size);
+        if (locals == NULL) {
+            continue;
+        }
+        memset(locals, 0, size);
+        for (int cpu_num = 0; cpu_num < num_available_cpus; cpu_num++) {
+            if (cpu_num_to_proximity_domain_idx[cpu_num] == (uint32_t)domain_idx) {
+                cpu_locals[cpu_num] = locals;
+                locals += LOCALS_STRIDE;
+            }
+        }
+    }
+}
+#endif
+
+static int wait_for_cpus(cpu_state_t cpu_state[MAX_CPUS], int first_cpu, int last_cpu)
+{
+    // Returns 0 once all the enabled CPUs in the range first_cpu to last_cpu - 1
+    // are running, or the lowest-numbered CPU that is still waiting after 10s.
+    int cpu_num = first_cpu;
+    int timeout = 10*1000*10;
+    while (timeout > 0) {
+        while (cpu_num < last_cpu && cpu_state[cpu_num] != CPU_STATE_ENABLED) {
+            cpu_num++;
+        }
+        if (cpu_num == last_cpu) {
+            return 0;
+        }
+        usleep(100);
+        timeout--;
+    }
+    return cpu_num;
+}
+
 //------------------------------------------------------------------------------
 // Public Functions
 //------------------------------------------------------------------------------
@@ -1058,9 +1351,21 @@ void smp_init(bool smp_enable)
 #endif
     }
 
+    if (num_available_cpus > 1) {
+        move_bsp_to_cpu_0();
+#if defined(__i386__) || defined(__x86_64__)
+        select_apic_mode();
+#endif
+    }
+    build_apic_id_hash();
+
     if (smp_enable) {
         if (find_numa_nodes_in_srat()) {
             check_if_needs_to_map();
+            if (num_proximity_domains > 1) {
+                parse_slit(acpi_config.slit_addr);
+                order_remote_proximity_domains();
+            }
         } else {
             // Do nothing.
         }
@@ -1071,6 +1376,12 @@ void smp_init(bool smp_enable)
         cpus_in_proximity_domain[proximity_domain_idx]++;
     }
 
+#if defined(__i386__) || defined(__x86_64__)
+    if (num_proximity_domains > 1) {
+        place_cpu_locals_in_proximity_domains();
+    }
+#endif
+
     // Allocate a page of low memory for AP trampoline and sync objects.
     // These need to remain pinned in place during relocation.
     smp_heap_page = heap_alloc(HEAP_TYPE_LM_1, PAGE_SIZE, PAGE_SIZE) >> PAGE_SHIFT;
@@ -1094,41 +1405,32 @@ int smp_start(cpu_state_t cpu_state[MAX_CPUS])
 
     cpu_state[0] = CPU_STATE_RUNNING;  // we don't support disabling the boot CPU
 
+#if defined(__i386__) || defined(__x86_64__)
+    if (!SEQUENTIAL_AP_START) {
+        // Step all the enabled APs through the start-up sequence together and
+        // wait for them collectively. If any fail to respond, fall back to
+        // starting those that are still waiting one at a time.
+        if (start_cpus_in_parallel(cpu_state) && wait_for_cpus(cpu_state, 1, num_available_cpus) == 0) {
+            return 0;
+        }
+    }
+    bool sequential = true;
+#else
+    bool sequential = SEQUENTIAL_AP_START;
+#endif
+
     for (cpu_num = 1; cpu_num < num_available_cpus; cpu_num++) {
         if (cpu_state[cpu_num] == CPU_STATE_ENABLED) {
             if (!start_cpu(cpu_num)) {
                 return cpu_num;
             }
+            if (sequential && wait_for_cpus(cpu_state, cpu_num, cpu_num + 1) != 0) {
+                return cpu_num;
+            }
         }
-#if SEQUENTIAL_AP_START
-        int timeout = 10*1000*10;
-        while (timeout > 0) {
-            if (cpu_state[cpu_num] == CPU_STATE_RUNNING) break;
-            usleep(100);
-            timeout--;
-        }
-        if (cpu_state[cpu_num] != CPU_STATE_RUNNING) {
-            return cpu_num;
-        }
-#endif
     }
 
-#if SEQUENTIAL_AP_START
-    return 0;
-#else
-    int timeout = 10*1000*10;
-    while (timeout > 0) {
-        for (cpu_num = 1; cpu_num < num_available_cpus; cpu_num++) {
-            if (cpu_state[cpu_num] == CPU_STATE_ENABLED) break;
-        }
-        if (cpu_num == num_available_cpus) {
-            return 0;
-        }
-        usleep(100);
-        timeout--;
-    }
-    return cpu_num;
-#endif
+    return sequential ? 0 : wait_for_cpus(cpu_state, 1, num_available_cpus);
 }
 
 void smp_send_nmi(int cpu_num)
@@ -1145,11 +1447,14 @@ int smp_my_cpu_num(void)
 {
     if (num_available_cpus <= 1) return 0;
 
-    int apic_id = my_apic_id();
-    for (int i = 0; i < num_available_cpus; i++) {
-        if ((int)cpu_num_to_apic_id[i] == apic_id) {
-            return i;
+    uint32_t apic_id = my_apic_id();
+    int i = apic_id & (APIC_ID_HASH_SIZE - 1);
+    while (apic_id_to_cpu_num[i] != 0) {
+        int cpu_num = apic_id_to_cpu_num[i] - 1;
+        if (cpu_num_to_apic_id[cpu_num] == apic_id) {
+            return cpu_num;
         }
+        i = (i + 1) & (APIC_ID_HASH_SIZE - 1);
     }
     return 0;
 }
@@ -1159,6 +1464,23 @@ uint32_t smp_get_proximity_domain_idx(int cpu_num)
     return num_available_cpus > 1 ? cpu_num_to_proximity_domain_idx[cpu_num] : 0;
 }
 
+uint32_t smp_get_remote_proximity_domain_idx(uint32_t proximity_domain_idx, int pass_num)
+{
+    if (num_proximity_domains < 2) {
+        return proximity_domain_idx;
+    }
+    int offset = remote_domain_offsets[pass_num % (num_proximity_domains - 1)];
+    return (proximity_domain_idx + offset) % num_proximity_domains;
+}
+
+int smp_get_proximity_domain_distance(uint32_t from_idx, uint32_t to_idx)
+{
+    if (from_idx >= MAX_SLIT_DOMAINS || to_idx >= MAX_SLIT_DOMAINS) {
+        return 0;
+    }
+    return proximity_domain_distance[from_idx][to_idx];
+}
+
 int smp_narrow_to_proximity_domain(uint64_t start, uint64_t end, uint32_t * proximity_domain_idx, uint64_t * new_start, uint64_t * new_end)
 {
     for (int i = 0; i < num_memory_affinity_ranges; i++) {
@@ -1222,6 +1544,7 @@ void get_memory_affinity_entry(int idx, uint32_t * proximity_domain_idx, uint64_
 
 barrier_t *smp_alloc_barrier(int num_threads)
 {
+    alloc_addr = (alloc_addr + SYNC_OBJECT_ALIGN - 1) & ~(uintptr_t)(SYNC_OBJECT_ALIGN - 1);
     barrier_t *barrier = (barrier_t *)(alloc_addr);
     alloc_addr += sizeof(barrier_t);
     barrier_init(barrier, num_threads);
@@ -1230,6 +1553,7 @@ barrier_t *smp_alloc_barrier(int num_threads)
 
 spinlock_t *smp_alloc_mutex()
 {
+    alloc_addr = (alloc_addr + SYNC_OBJECT_ALIGN - 1) & ~(uintptr_t)(SYNC_OBJECT_ALIGN - 1);
     spinlock_t *mutex = (spinlock_t *)(alloc_addr);
     alloc_addr += sizeof(spinlock_t);
     spin_unlock(mutex);
@@ -11,6 +11,7 @@
  */
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "boot.h"
@@ -54,6 +55,13 @@ extern int num_available_cpus;
  */
 extern int num_proximity_domains;
 
+/**
+ * The number of bytes of memory set aside for the node-local CPU data, which
+ * is excluded from the memory tests. This is 0 unless there is more than one
+ * proximity domain.
+ */
+extern size_t num_node_local_bytes;
+
 /**
  * Initialises the SMP state and detects the number of available CPU cores.
  */
@@ -94,6 +102,19 @@ static inline uint16_t smp_alloc_cpu_in_proximity_domain(uint32_t proximity_doma
     return chunk_index;
 }
 
+/**
+ * Returns the index of the proximity domain whose memory is tested by the
+ * CPU cores in proximity domain proximity_domain_idx on pass pass_num, when
+ * remote NUMA testing is enabled. Successive passes rotate through the other
+ * proximity domains, starting with the nearest by SLIT distance.
+ */
+uint32_t smp_get_remote_proximity_domain_idx(uint32_t proximity_domain_idx, int pass_num);
+
+/**
+ * Returns the SLIT distance between two proximity domains, or 0 if unknown.
+ */
+int smp_get_proximity_domain_distance(uint32_t from_idx, uint32_t to_idx);
+
 /**
  * Computes the first span, limited to a single proximity domain, of the given memory range.
  */
@@ -19,9 +19,32 @@
 #define DDR5_ROUNDING_FACTOR    30
 #define ROUNDING_FACTOR         0.9f
 
+#define SPD_CACHE_CHUNK         32      // bytes per I2C block read (divides the SPD page sizes)
+
 ram_info_t ram = { 0, 0, 0, 0, 0, 0, "N/A"};
 ram_slot_info_t ram_slot_info[MAX_SPD_SLOT];
 
+static uint8_t  spd_cache[MAX_SPD_SLOT][SPD_CACHE_SIZE];
+static uint32_t spd_cache_valid[MAX_SPD_SLOT];  // one bit per chunk
+
+uint8_t get_cached_spd(uint8_t slot_idx, uint16_t spd_adr)
+{
+    if (slot_idx >= MAX_SPD_SLOT || spd_adr >= SPD_CACHE_SIZE) {
+        return get_spd(slot_idx, spd_adr);
+    }
+
+    int chunk = spd_adr / SPD_CACHE_CHUNK;
+    if (!(spd_cache_valid[slot_idx] & (1U << chunk))) {
+        // If the block read isn't supported, just read the byte that's needed.
+        // Filling the chunk a byte at a time would read many unused bytes.
+        if (!get_spd_block(slot_idx, chunk * SPD_CACHE_CHUNK, &spd_cache[slot_idx][chunk * SPD_CACHE_CHUNK], SPD_CACHE_CHUNK)) {
+            return get_spd(slot_idx, spd_adr);
+        }
+        spd_cache_valid[slot_idx] |= 1U << chunk;
+    }
+    return spd_cache[slot_idx][spd_adr];
+}
+
 static inline uint8_t bcd_to_ui8(uint8_t bcd)
 {
     return bcd - 6 * (bcd >> 4);
@@ -104,7 +127,7 @@ static void read_sku(char *sku, uint8_t slot_idx, uint16_t offset, uint8_t max_l
         max_len = SPD_SKU_LEN;
 
     for (sku_len = 0; sku_len < max_len; sku_len++) {
-        uint8_t sku_byte = get_spd(slot_idx, offset + sku_len);
+        uint8_t sku_byte = get_cached_spd(slot_idx, offset + sku_len);
 
         // Stop on the first non-ASCII char
         if (sku_byte < 0x20 || sku_byte > 0x7F)
@@ -127,7 +150,7 @@ static void parse_spd_ddr5(spd_info *spdi, uint8_t slot_idx)
     // Compute module size for symmetric & asymmetric configuration
     for (int sbyte_adr = 1; sbyte_adr <= 2; sbyte_adr++) {
         uint32_t cur_rank = 0;
-        uint8_t sbyte = get_spd(slot_idx, sbyte_adr * 4);
+        uint8_t sbyte = get_cached_spd(slot_idx, sbyte_adr * 4);
 
         // SDRAM Density per die
         switch (sbyte & 0x1F)
@@ -165,7 +188,7 @@ static void parse_spd_ddr5(spd_info *spdi, uint8_t slot_idx)
             cur_rank *= 1U << (((sbyte >> 5) & 7) - 1);
         }
 
-        sbyte = get_spd(slot_idx, 235);
+        sbyte = get_cached_spd(slot_idx, 235);
         spdi->hasECC = (((sbyte >> 3) & 3) > 0);
 
         // Channels per DIMM
@@ -177,10 +200,10 @@ static void parse_spd_ddr5(spd_info *spdi, uint8_t slot_idx)
         cur_rank *= 1U << ((sbyte & 3) + 3);
 
         // I/O Width
-        sbyte = get_spd(slot_idx, (sbyte_adr * 4) + 2);
+        sbyte = get_cached_spd(slot_idx, (sbyte_adr * 4) + 2);
         cur_rank /= 1U << (((sbyte >> 5) & 3) + 2);
 
-        sbyte = get_spd(slot_idx, 234);
+        sbyte = get_cached_spd(slot_idx, 234);
 
         // Package ranks per Channel
         cur_rank *= 1U << ((sbyte >> 3) & 7);
@@ -198,14 +221,14 @@ static void parse_spd_ddr5(spd_info *spdi, uint8_t slot_idx)
     uint16_t tCK, tCKtmp, tns;
     int xmp_offset = 0;
 
-    spdi->XMP = ((get_spd(slot_idx, 640) == 0x0C && get_spd(slot_idx, 641) == 0x4A)) ? 3 : 0;
+    spdi->XMP = ((get_cached_spd(slot_idx, 640) == 0x0C && get_cached_spd(slot_idx, 641) == 0x4A)) ? 3 : 0;
 
     if (spdi->XMP == 3) {
         // XMP 3.0 (enumerate all profiles to find the fastest)
         tCK = 0;
         for (int offset = 0; offset < 2*64; offset += 64) {
-            tCKtmp = get_spd(slot_idx, 710 + offset) << 8 |
-                     get_spd(slot_idx, 709 + offset);
+            tCKtmp = get_cached_spd(slot_idx, 710 + offset) << 8 |
+                     get_cached_spd(slot_idx, 709 + offset);
 
             if (tCKtmp == 0 || tCKtmp < 100 || (tCK != 0 && tCKtmp >= tCK)) continue;
 
@@ -214,8 +237,8 @@ static void parse_spd_ddr5(spd_info *spdi, uint8_t slot_idx)
         }
     } else {
         // JEDEC
-        tCK = get_spd(slot_idx, 21) << 8 |
-              get_spd(slot_idx, 20);
+        tCK = get_cached_spd(slot_idx, 21) << 8 |
+              get_cached_spd(slot_idx, 20);
     }
 
     if (tCK == 0) {
@@ -232,29 +255,29 @@ static void parse_spd_ddr5(spd_info *spdi, uint8_t slot_idx)
         // ------------------
 
         // CAS# Latency
-        tns  = (uint16_t)get_spd(slot_idx, 718 + xmp_offset) << 8 |
-               (uint16_t)get_spd(slot_idx, 717 + xmp_offset);
+        tns  = (uint16_t)get_cached_spd(slot_idx, 718 + xmp_offset) << 8 |
+               (uint16_t)get_cached_spd(slot_idx, 717 + xmp_offset);
         spdi->tCL = (tns + tCK - DDR5_ROUNDING_FACTOR) / tCK;
         spdi->tCL += spdi->tCL % 2; // if tCL is odd, round to upper even.
 
         // RAS# to CAS# Latency
-        tns  = (uint16_t)get_spd(slot_idx, 720 + xmp_offset) << 8 |
-               (uint16_t)get_spd(slot_idx, 719 + xmp_offset);
+        tns  = (uint16_t)get_cached_spd(slot_idx, 720 + xmp_offset) << 8 |
+               (uint16_t)get_cached_spd(slot_idx, 719 + xmp_offset);
         spdi->tRCD = (tns + tCK - DDR5_ROUNDING_FACTOR) / tCK;
 
         // RAS# Precharge
-        tns  = (uint16_t)get_spd(slot_idx, 722 + xmp_offset) << 8 |
-               (uint16_t)get_spd(slot_idx, 721 + xmp_offset);
+        tns  = (uint16_t)get_cached_spd(slot_idx, 722 + xmp_offset) << 8 |
+               (uint16_t)get_cached_spd(slot_idx, 721 + xmp_offset);
         spdi->tRP = (tns + tCK - DDR5_ROUNDING_FACTOR) / tCK;
 
         // Row Active Time
-        tns  = (uint16_t)get_spd(slot_idx, 724 + xmp_offset) << 8 |
-               (uint16_t)get_spd(slot_idx, 723 + xmp_offset);
+        tns  = (uint16_t)get_cached_spd(slot_idx, 724 + xmp_offset) << 8 |
+               (uint16_t)get_cached_spd(slot_idx, 723 + xmp_offset);
         spdi->tRAS = (tns + tCK - DDR5_ROUNDING_FACTOR) / tCK;
 
         // Row Cycle Time
-        tns  = (uint16_t)get_spd(slot_idx, 726 + xmp_offset) << 8 |
-               (uint16_t)get_spd(slot_idx, 725 + xmp_offset);
+        tns  = (uint16_t)get_cached_spd(slot_idx, 726 + xmp_offset) << 8 |
+               (uint16_t)get_cached_spd(slot_idx, 725 + xmp_offset);
         spdi->tRC = (tns + tCK - DDR5_ROUNDING_FACTOR) / tCK;
     } else {
         // --------------------
@@ -262,40 +285,40 @@ static void parse_spd_ddr5(spd_info *spdi, uint8_t slot_idx)
         // --------------------
 
         // CAS# Latency
-        tns  = (uint16_t)get_spd(slot_idx, 31) << 8 |
-               (uint16_t)get_spd(slot_idx, 30);
+        tns  = (uint16_t)get_cached_spd(slot_idx, 31) << 8 |
+               (uint16_t)get_cached_spd(slot_idx, 30);
         spdi->tCL = (tns + tCK - DDR5_ROUNDING_FACTOR) / tCK;
         spdi->tCL += spdi->tCL % 2;
 
         // RAS# to CAS# Latency
-        tns  = (uint16_t)get_spd(slot_idx, 33) << 8 |
-               (uint16_t)get_spd(slot_idx, 32);
+        tns  = (uint16_t)get_cached_spd(slot_idx, 33) << 8 |
+               (uint16_t)get_cached_spd(slot_idx, 32);
         spdi->tRCD = (tns + tCK - DDR5_ROUNDING_FACTOR) / tCK;
 
         // RAS# Precharge
-        tns  = (uint16_t)get_spd(slot_idx, 35) << 8 |
-               (uint16_t)get_spd(slot_idx, 34);
+        tns  = (uint16_t)get_cached_spd(slot_idx, 35) << 8 |
+               (uint16_t)get_cached_spd(slot_idx, 34);
         spdi->tRP = (tns + tCK - DDR5_ROUNDING_FACTOR) / tCK;
 
         // Row Active Time
-        tns  = (uint16_t)get_spd(slot_idx, 37) << 8 |
-               (uint16_t)get_spd(slot_idx, 36);
+        tns  = (uint16_t)get_cached_spd(slot_idx, 37) << 8 |
+               (uint16_t)get_cached_spd(slot_idx, 36);
         spdi->tRAS = (tns + tCK - DDR5_ROUNDING_FACTOR) / tCK;
 
         // Row Cycle Time
-        tns  = (uint16_t)get_spd(slot_idx, 39) << 8 |
-               (uint16_t)get_spd(slot_idx, 38);
+        tns  = (uint16_t)get_cached_spd(slot_idx, 39) << 8 |
+               (uint16_t)get_cached_spd(slot_idx, 38);
         spdi->tRC = (tns + tCK - DDR5_ROUNDING_FACTOR) / tCK;
     }
 
     // Module manufacturer
-    spdi->jedec_code = (get_spd(slot_idx, 512) & 0x1F) << 8;
-    spdi->jedec_code |= get_spd(slot_idx, 513) & 0x7F;
+    spdi->jedec_code = (get_cached_spd(slot_idx, 512) & 0x1F) << 8;
+    spdi->jedec_code |= get_cached_spd(slot_idx, 513) & 0x7F;
 
     read_sku(spdi->sku, slot_idx, 521, 30);
 
-    spdi->fab_year = bcd_to_ui8(get_spd(slot_idx, 515));
-    spdi->fab_week = bcd_to_ui8(get_spd(slot_idx, 516));
+    spdi->fab_year = bcd_to_ui8(get_cached_spd(slot_idx, 515));
+    spdi->fab_week = bcd_to_ui8(get_cached_spd(slot_idx, 516));
 
     // All DDR5s should have temperature sensor. Add a check if proved wrong.
     spdi->hasTempSensor = true;
@@ -309,29 +332,29 @@ static void parse_spd_ddr4(spd_info *spdi, uint8_t slot_idx)
 
     // Compute module size in MB with shifts
     spdi->module_size = 1U << (
-                               ((get_spd(slot_idx, 4) & 0xF) + 5)   +  // Total SDRAM capacity: (256 Mbits << byte4[3:0] with an oddity for values >= 8) / 1 KB
-                               ((get_spd(slot_idx, 13) & 0x7) + 3)  -  // Primary Bus Width: 8 << byte13[2:0]
-                               ((get_spd(slot_idx, 12) & 0x7) + 2)  +  // SDRAM Device Width: 4 << byte12[2:0]
-                               ((get_spd(slot_idx, 12) >> 3) & 0x7) +  // Number of Ranks: byte12[5:3]
-                               ((get_spd(slot_idx, 6) >> 4) & 0x7)     // Die count - 1: byte6[6:4]
+                               ((get_cached_spd(slot_idx, 4) & 0xF) + 5)   +  // Total SDRAM capacity: (256 Mbits << byte4[3:0] with an oddity for values >= 8) / 1 KB
+                               ((get_cached_spd(slot_idx, 13) & 0x7) + 3)  -  // Primary Bus Width: 8 << byte13[2:0]
+                               ((get_cached_spd(slot_idx, 12) & 0x7) + 2)  +  // SDRAM Device Width: 4 << byte12[2:0]
+                               ((get_cached_spd(slot_idx, 12) >> 3) & 0x7) +  // Number of Ranks: byte12[5:3]
+                               ((get_cached_spd(slot_idx, 6) >> 4) & 0x7)     // Die count - 1: byte6[6:4]
                               );
 
-    spdi->hasECC = (((get_spd(slot_idx, 13) >> 3) & 1) == 1);
+    spdi->hasECC = (((get_cached_spd(slot_idx, 13) >> 3) & 1) == 1);
 
     // Module max clock
     float tns, tCK, ramfreq, fround;
 
-    if (get_spd(slot_idx, 384) == 0x0C && get_spd(slot_idx, 385) == 0x4A) {
+    if (get_cached_spd(slot_idx, 384) == 0x0C && get_cached_spd(slot_idx, 385) == 0x4A) {
         // Max XMP
-        tCK = (uint8_t)get_spd(slot_idx, 396) * 0.125f +
-              (int8_t)get_spd(slot_idx, 431)  * 0.001f;
+        tCK = (uint8_t)get_cached_spd(slot_idx, 396) * 0.125f +
+              (int8_t)get_cached_spd(slot_idx, 431)  * 0.001f;
 
         spdi->XMP = 2;
 
     } else {
         // Max JEDEC
-        tCK = (uint8_t)get_spd(slot_idx, 18) * 0.125f +
-              (int8_t)get_spd(slot_idx, 125) * 0.001f;
+        tCK = (uint8_t)get_cached_spd(slot_idx, 18) * 0.125f +
+              (int8_t)get_cached_spd(slot_idx, 125) * 0.001f;
     }
 
     ramfreq = 1.0f / tCK * 2.0f * 1000.0f;
@@ -355,29 +378,29 @@ static void parse_spd_ddr4(spd_info *spdi, uint8_t slot_idx)
         // ------------------
 
         // CAS# Latency
-        tns  = (uint8_t)get_spd(slot_idx, 401) * 0.125f +
-               (int8_t)get_spd(slot_idx, 430)  * 0.001f;
+        tns  = (uint8_t)get_cached_spd(slot_idx, 401) * 0.125f +
+               (int8_t)get_cached_spd(slot_idx, 430)  * 0.001f;
         spdi->tCL = (uint16_t)(tns/tCK + ROUNDING_FACTOR);
 
         // RAS# to CAS# Latency
-        tns  = (uint8_t)get_spd(slot_idx, 402) * 0.125f +
-               (int8_t)get_spd(slot_idx, 429)  * 0.001f;
+        tns  = (uint8_t)get_cached_spd(slot_idx, 402) * 0.125f +
+               (int8_t)get_cached_spd(slot_idx, 429)  * 0.001f;
         spdi->tRCD = (uint16_t)(tns/tCK + ROUNDING_FACTOR);
 
         // RAS# Precharge
-        tns  = (uint8_t)get_spd(slot_idx, 403) * 0.125f +
-               (int8_t)get_spd(slot_idx, 428)  * 0.001f;
+        tns  = (uint8_t)get_cached_spd(slot_idx, 403) * 0.125f +
+               (int8_t)get_cached_spd(slot_idx, 428)  * 0.001f;
         spdi->tRP = (uint16_t)(tns/tCK + ROUNDING_FACTOR);
 
         // Row Active Time
-        tns = (uint8_t)get_spd(slot_idx, 405) * 0.125f +
-              (int8_t)get_spd(slot_idx, 427)  * 0.001f  +
-              (uint8_t)(get_spd(slot_idx, 404) & 0x0F) * 32.0f;
+        tns = (uint8_t)get_cached_spd(slot_idx, 405) * 0.125f +
+              (int8_t)get_cached_spd(slot_idx, 427)  * 0.001f  +
+              (uint8_t)(get_cached_spd(slot_idx, 404) & 0x0F) * 32.0f;
         spdi->tRAS = (uint16_t)(tns/tCK + ROUNDING_FACTOR);
 
         // Row Cycle Time
-        tns = (uint8_t)get_spd(slot_idx, 406) * 0.125f +
-              (uint8_t)(get_spd(slot_idx, 404) >> 4) * 32.0f;
+        tns = (uint8_t)get_cached_spd(slot_idx, 406) * 0.125f +
+              (uint8_t)(get_cached_spd(slot_idx, 404) >> 4) * 32.0f;
         spdi->tRC = (uint16_t)(tns/tCK + ROUNDING_FACTOR);
     } else {
         // --------------------
@@ -385,39 +408,39 @@ static void parse_spd_ddr4(spd_info *spdi, uint8_t slot_idx)
         // --------------------
 
         // CAS# Latency
-        tns  = (uint8_t)get_spd(slot_idx, 24) * 0.125f +
-               (int8_t)get_spd(slot_idx, 123) * 0.001f;
+        tns  = (uint8_t)get_cached_spd(slot_idx, 24) * 0.125f +
+               (int8_t)get_cached_spd(slot_idx, 123) * 0.001f;
         spdi->tCL = (uint16_t)(tns/tCK + ROUNDING_FACTOR);
 
         // RAS# to CAS# Latency
-        tns  = (uint8_t)get_spd(slot_idx, 25) * 0.125f +
-               (int8_t)get_spd(slot_idx, 122) * 0.001f;
+        tns  = (uint8_t)get_cached_spd(slot_idx, 25) * 0.125f +
+               (int8_t)get_cached_spd(slot_idx, 122) * 0.001f;
         spdi->tRCD = (uint16_t)(tns/tCK + ROUNDING_FACTOR);
 
         // RAS# Precharge
-        tns  = (uint8_t)get_spd(slot_idx, 26) * 0.125f +
-               (int8_t)get_spd(slot_idx, 121) * 0.001f;
+        tns  = (uint8_t)get_cached_spd(slot_idx, 26) * 0.125f +
+               (int8_t)get_cached_spd(slot_idx, 121) * 0.001f;
         spdi->tRP = (uint16_t)(tns/tCK + ROUNDING_FACTOR);
 
         // Row Active Time
-        tns = (uint8_t)get_spd(slot_idx, 28) * 0.125f +
-              (uint8_t)(get_spd(slot_idx, 27) & 0x0F) * 32.0f;
+        tns = (uint8_t)get_cached_spd(slot_idx, 28) * 0.125f +
+              (uint8_t)(get_cached_spd(slot_idx, 27) & 0x0F) * 32.0f;
         spdi->tRAS = (uint16_t)(tns/tCK + ROUNDING_FACTOR);
 
         // Row Cycle Time
-        tns = (uint8_t)get_spd(slot_idx, 29) * 0.125f +
-              (uint8_t)(get_spd(slot_idx, 27) >> 4) * 32.0f;
+        tns = (uint8_t)get_cached_spd(slot_idx, 29) * 0.125f +
+              (uint8_t)(get_cached_spd(slot_idx, 27) >> 4) * 32.0f;
         spdi->tRC = (uint16_t)(tns/tCK + ROUNDING_FACTOR);
     }
 
     // Module manufacturer
-    spdi->jedec_code  = ((uint16_t)(get_spd(slot_idx, 320) & 0x1F)) << 8;
-    spdi->jedec_code |= get_spd(slot_idx, 321) & 0x7F;
+    spdi->jedec_code  = ((uint16_t)(get_cached_spd(slot_idx, 320) & 0x1F)) << 8;
+    spdi->jedec_code |= get_cached_spd(slot_idx, 321) & 0x7F;
 
     read_sku(spdi->sku, slot_idx, 329, 20);
 
-    spdi->fab_year = bcd_to_ui8(get_spd(slot_idx, 323));
-    spdi->fab_week = bcd_to_ui8(get_spd(slot_idx, 324));
+    spdi->fab_year = bcd_to_ui8(get_cached_spd(slot_idx, 323));
+    spdi->fab_week = bcd_to_ui8(get_cached_spd(slot_idx, 324));
 
     spdi->hasTempSensor = false;
 
@@ -430,20 +453,20 @@ static void parse_spd_ddr3(spd_info *spdi, uint8_t slot_idx)
 
     // Compute module size in MB with shifts
     spdi->module_size = 1U << (
-                               ((get_spd(slot_idx, 4) & 0xF) + 5)  +  // Total SDRAM capacity: (256 Mbits << byte4[3:0]) / 1 KB
-                               ((get_spd(slot_idx, 8) & 0x7) + 3)  -  // Primary Bus Width: 8 << byte8[2:0]
-                               ((get_spd(slot_idx, 7) & 0x7) + 2)     // SDRAM Device Width: 4 << byte7[2:0]
+                               ((get_cached_spd(slot_idx, 4) & 0xF) + 5)  +  // Total SDRAM capacity: (256 Mbits << byte4[3:0]) / 1 KB
+                               ((get_cached_spd(slot_idx, 8) & 0x7) + 3)  -  // Primary Bus Width: 8 << byte8[2:0]
+                               ((get_cached_spd(slot_idx, 7) & 0x7) + 2)     // SDRAM Device Width: 4 << byte7[2:0]
                               );
 
-    spdi->module_size *= ((get_spd(slot_idx, 7) >> 3) & 0x7) + 1;     // Number of Ranks: byte7[5:3]
+    spdi->module_size *= ((get_cached_spd(slot_idx, 7) >> 3) & 0x7) + 1;     // Number of Ranks: byte7[5:3]
 
-    spdi->hasECC = (((get_spd(slot_idx, 8) >> 3) & 1) == 1);
+    spdi->hasECC = (((get_cached_spd(slot_idx, 8) >> 3) & 1) == 1);
 
-    uint8_t tck = get_spd(slot_idx, 12);
-    uint8_t tck2 = get_spd(slot_idx, 221);
+    uint8_t tck = get_cached_spd(slot_idx, 12);
+    uint8_t tck2 = get_cached_spd(slot_idx, 221);
 
-    if (get_spd(slot_idx, 176) == 0x0C && get_spd(slot_idx, 177) == 0x4A) {
-        tck = get_spd(slot_idx, 186);
+    if (get_cached_spd(slot_idx, 176) == 0x0C && get_cached_spd(slot_idx, 177) == 0x4A) {
+        tck = get_cached_spd(slot_idx, 186);
 
         // Check if profile #2 is faster
         if (tck2 > 5 && tck2 < tck) {
@@ -492,12 +515,12 @@ static void parse_spd_ddr3(spd_info *spdi, uint8_t slot_idx)
         // ------------------
         // XMP Specifications
         // ------------------
-        float mtb_dividend = get_spd(slot_idx, 180);
-        float mtb_divisor = get_spd(slot_idx, 181);
+        float mtb_dividend = get_cached_spd(slot_idx, 180);
+        float mtb_divisor = get_cached_spd(slot_idx, 181);
 
         mtb = (mtb_divisor == 0) ? 0.125f : mtb_dividend / mtb_divisor;
 
-        tckns = (float)get_spd(slot_idx, 186);
+        tckns = (float)get_cached_spd(slot_idx, 186);
 
         // XMP Draft with non-standard MTB divisors (!= 0.125)
         if (mtb_divisor == 12.0f && tckns == 10.0f) {
@@ -513,26 +536,26 @@ static void parse_spd_ddr3(spd_info *spdi, uint8_t slot_idx)
         tckns *= mtb;
 
         // CAS# Latency
-        tns  = get_spd(slot_idx, 187);
+        tns  = get_cached_spd(slot_idx, 187);
         spdi->tCL = (uint16_t)((tns*mtb)/tckns + ROUNDING_FACTOR);
 
         // RAS# to CAS# Latency
-        tns  = get_spd(slot_idx, 192);
+        tns  = get_cached_spd(slot_idx, 192);
         spdi->tRCD = (uint16_t)((tns*mtb)/tckns + ROUNDING_FACTOR);
 
         // RAS# Precharge
-        tns  = get_spd(slot_idx, 191);
+        tns  = get_cached_spd(slot_idx, 191);
         spdi->tRP = (uint16_t)((tns*mtb)/tckns + ROUNDING_FACTOR);
 
         // Row Active Time
-        tns  = (uint16_t)((get_spd(slot_idx, 194) & 0x0F) << 8 |
-               get_spd(slot_idx, 195));
+        tns  = (uint16_t)((get_cached_spd(slot_idx, 194) & 0x0F) << 8 |
+               get_cached_spd(slot_idx, 195));
 
         spdi->tRAS = (uint16_t)((tns*mtb)/tckns + ROUNDING_FACTOR);
 
         // Row Cycle Time
-        tns  = (uint16_t)((get_spd(slot_idx, 194) & 0xF0) << 4 |
-               get_spd(slot_idx, 196));
+        tns  = (uint16_t)((get_cached_spd(slot_idx, 194) & 0xF0) << 4 |
+               get_cached_spd(slot_idx, 196));
         spdi->tRC = (uint16_t)((tns*mtb)/tckns + ROUNDING_FACTOR);
     } else {
         // --------------------
@@ -540,43 +563,43 @@ static void parse_spd_ddr3(spd_info *spdi, uint8_t slot_idx)
         // --------------------
         mtb = 0.125f;
 
-        tckns = (uint8_t)get_spd(slot_idx, 12) * mtb +
-                (int8_t)get_spd(slot_idx, 34) * 0.001f;
+        tckns = (uint8_t)get_cached_spd(slot_idx, 12) * mtb +
+                (int8_t)get_cached_spd(slot_idx, 34) * 0.001f;
 
         // CAS# Latency
-        tns  = (uint8_t)get_spd(slot_idx, 16) * mtb +
-               (int8_t)get_spd(slot_idx, 35) * 0.001f;
+        tns  = (uint8_t)get_cached_spd(slot_idx, 16) * mtb +
+               (int8_t)get_cached_spd(slot_idx, 35) * 0.001f;
         spdi->tCL = (uint16_t)(tns/tckns + ROUNDING_FACTOR);
 
         // RAS# to CAS# Latency
-        tns  = (uint8_t)get_spd(slot_idx, 18) * mtb +
-               (int8_t)get_spd(slot_idx, 36) * 0.001f;
+        tns  = (uint8_t)get_cached_spd(slot_idx, 18) * mtb +
+               (int8_t)get_cached_spd(slot_idx, 36) * 0.001f;
         spdi->tRCD = (uint16_t)(tns/tckns + ROUNDING_FACTOR);
 
         // RAS# Precharge
-        tns  = (uint8_t)get_spd(slot_idx, 20) * mtb +
-               (int8_t)get_spd(slot_idx, 37) * 0.001f;
+        tns  = (uint8_t)get_cached_spd(slot_idx, 20) * mtb +
+               (int8_t)get_cached_spd(slot_idx, 37) * 0.001f;
         spdi->tRP = (uint16_t)(tns/tckns + ROUNDING_FACTOR);
 
         // Row Active Time
-        tns = (uint8_t)get_spd(slot_idx, 22) * mtb +
-              (uint8_t)(get_spd(slot_idx, 21) & 0x0F) * 32.0f;
+        tns = (uint8_t)get_cached_spd(slot_idx, 22) * mtb +
+              (uint8_t)(get_cached_spd(slot_idx, 21) & 0x0F) * 32.0f;
         spdi->tRAS = (uint16_t)(tns/tckns + ROUNDING_FACTOR);
 
         // Row Cycle Time
-        tns = (uint8_t)get_spd(slot_idx, 23) * mtb +
-              (uint8_t)(get_spd(slot_idx, 21) >> 4) * 32.0f + 1;
+        tns = (uint8_t)get_cached_spd(slot_idx, 23) * mtb +
+              (uint8_t)(get_cached_spd(slot_idx, 21) >> 4) * 32.0f + 1;
         spdi->tRC = (uint16_t)(tns/tckns  + ROUNDING_FACTOR);
     }
 
     // Module manufacturer
-    spdi->jedec_code  = ((uint16_t)(get_spd(slot_idx, 117) & 0x1F)) << 8;
-    spdi->jedec_code |= get_spd(slot_idx, 118) & 0x7F;
+    spdi->jedec_code  = ((uint16_t)(get_cached_spd(slot_idx, 117) & 0x1F)) << 8;
+    spdi->jedec_code |= get_cached_spd(slot_idx, 118) & 0x7F;
 
     read_sku(spdi->sku, slot_idx, 128, 18);
 
-    spdi->fab_year = bcd_to_ui8(get_spd(slot_idx, 120));
-    spdi->fab_week = bcd_to_ui8(get_spd(slot_idx, 121));
+    spdi->fab_year = bcd_to_ui8(get_cached_spd(slot_idx, 120));
+    spdi->fab_week = bcd_to_ui8(get_cached_spd(slot_idx, 121));
 
     spdi->hasTempSensor = false;
 
@@ -588,7 +611,7 @@ static void parse_spd_ddr2(spd_info *spdi, uint8_t slot_idx)
     spdi->type = "DDR2";
 
     // Compute module size in MB
-    switch (get_spd(slot_idx, 31)) {
+    switch (get_cached_spd(slot_idx, 31)) {
         case 1:
             spdi->module_size = 1024;
             break;
@@ -616,21 +639,21 @@ static void parse_spd_ddr2(spd_info *spdi, uint8_t slot_idx)
             break;
     }
 
-    spdi->module_size *= (get_spd(slot_idx, 5) & 7) + 1;
+    spdi->module_size *= (get_cached_spd(slot_idx, 5) & 7) + 1;
 
-    spdi->hasECC = ((get_spd(slot_idx, 11) >> 1) == 1);
+    spdi->hasECC = ((get_cached_spd(slot_idx, 11) >> 1) == 1);
 
     float tckns, tns;
     uint8_t tbyte;
 
     // Module EPP Detection (we only support Full profiles)
     uint8_t epp_offset = 0;
-    if (get_spd(slot_idx, 99) == 0x6D && get_spd(slot_idx, 102) == 0xB1) {
-        epp_offset = (get_spd(slot_idx, 103) & 0x3) * 12;
-        tbyte = get_spd(slot_idx, 109 + epp_offset);
+    if (get_cached_spd(slot_idx, 99) == 0x6D && get_cached_spd(slot_idx, 102) == 0xB1) {
+        epp_offset = (get_cached_spd(slot_idx, 103) & 0x3) * 12;
+        tbyte = get_cached_spd(slot_idx, 109 + epp_offset);
         spdi->XMP = 20;
     } else {
-        tbyte = get_spd(slot_idx, 9);
+        tbyte = get_cached_spd(slot_idx, 9);
     }
 
     // Module speed
@@ -656,7 +679,7 @@ static void parse_spd_ddr2(spd_info *spdi, uint8_t slot_idx)
     if (spdi->XMP == 20) {
         // Module Timings (EPP)
         // CAS# Latency
-        tbyte = get_spd(slot_idx, 110 + epp_offset);
+        tbyte = get_cached_spd(slot_idx, 110 + epp_offset);
         for (int shft = 0; shft < 7; shft++) {
             if ((tbyte >> shft) & 1) {
                 spdi->tCL = shft;
@@ -664,22 +687,22 @@ static void parse_spd_ddr2(spd_info *spdi, uint8_t slot_idx)
         }
 
         // RAS# to CAS# Latency
-        tbyte = get_spd(slot_idx, 111 + epp_offset);
+        tbyte = get_cached_spd(slot_idx, 111 + epp_offset);
         tns = ((tbyte & 0xFC) >> 2) + (tbyte & 0x3) * 0.25f;
         spdi->tRCD = (uint16_t)(tns/tckns + ROUNDING_FACTOR);
 
         // RAS# Precharge
-        tbyte = get_spd(slot_idx, 112 + epp_offset);
+        tbyte = get_cached_spd(slot_idx, 112 + epp_offset);
         tns = ((tbyte & 0xFC) >> 2) + (tbyte & 0x3) * 0.25f;
         spdi->tRP = (uint16_t)(tns/tckns + ROUNDING_FACTOR);
 
         // Row Active Time
-        tns = get_spd(slot_idx, 113 + epp_offset);
+        tns = get_cached_spd(slot_idx, 113 + epp_offset);
         spdi->tRAS = (uint16_t)(tns/tckns + ROUNDING_FACTOR);
     } else {
         // Module Timings (JEDEC)
         // CAS# Latency
-        tbyte = get_spd(slot_idx, 18);
+        tbyte = get_cached_spd(slot_idx, 18);
         for (int shft = 0; shft < 7; shft++) {
             if ((tbyte >> shft) & 1) {
                 spdi->tCL = shft;
@@ -687,35 +710,35 @@ static void parse_spd_ddr2(spd_info *spdi, uint8_t slot_idx)
         }
 
         // RAS# to CAS# Latency
-        tbyte = get_spd(slot_idx, 29);
+        tbyte = get_cached_spd(slot_idx, 29);
         tns = ((tbyte & 0xFC) >> 2) + (tbyte & 0x3) * 0.25f;
         spdi->tRCD = (uint16_t)(tns/tckns + ROUNDING_FACTOR);
 
         // RAS# Precharge
-        tbyte = get_spd(slot_idx, 27);
+        tbyte = get_cached_spd(slot_idx, 27);
         tns = ((tbyte & 0xFC) >> 2) + (tbyte & 0x3) * 0.25f;
         spdi->tRP = (uint16_t)(tns/tckns + ROUNDING_FACTOR);
 
         // Row Active Time
-        tns = get_spd(slot_idx, 30);
+        tns = get_cached_spd(slot_idx, 30);
         spdi->tRAS = (uint16_t)(tns/tckns + ROUNDING_FACTOR);
     }
 
     // Module manufacturer
     uint8_t contcode;
     for (contcode = 64; contcode < 72; contcode++) {
-        if (get_spd(slot_idx, contcode) != 0x7F) {
+        if (get_cached_spd(slot_idx, contcode) != 0x7F) {
             break;
         }
     }
 
     spdi->jedec_code  = ((uint16_t)(contcode - 64)) << 8;
-    spdi->jedec_code |= get_spd(slot_idx, contcode) & 0x7F;
+    spdi->jedec_code |= get_cached_spd(slot_idx, contcode) & 0x7F;
 
     read_sku(spdi->sku, slot_idx, 73, 18);
 
-    spdi->fab_year = bcd_to_ui8(get_spd(slot_idx, 93));
-    spdi->fab_week = bcd_to_ui8(get_spd(slot_idx, 94));
+    spdi->fab_year = bcd_to_ui8(get_cached_spd(slot_idx, 93));
+    spdi->fab_week = bcd_to_ui8(get_cached_spd(slot_idx, 94));
 
     spdi->hasTempSensor = false;
 
@@ -727,7 +750,7 @@ static void parse_spd_ddr(spd_info *spdi, uint8_t slot_idx)
     spdi->type = "DDR";
 
     // Compute module size in MB
-    switch (get_spd(slot_idx, 31)) {
+    switch (get_cached_spd(slot_idx, 31)) {
         case 1:
             spdi->module_size = 1024;
             break;
@@ -757,19 +780,19 @@ static void parse_spd_ddr(spd_info *spdi, uint8_t slot_idx)
             break;
     }
 
-    spdi->module_size *= get_spd(slot_idx, 5);
+    spdi->module_size *= get_cached_spd(slot_idx, 5);
 
-    spdi->hasECC = ((get_spd(slot_idx, 11) >> 1) == 1);
+    spdi->hasECC = ((get_cached_spd(slot_idx, 11) >> 1) == 1);
 
     // Module speed
     float tns, tckns;
-    uint8_t spd_byte9 = get_spd(slot_idx, 9);
+    uint8_t spd_byte9 = get_cached_spd(slot_idx, 9);
     tckns = (spd_byte9 >> 4) + (spd_byte9 & 0xF) * 0.1f;
 
     spdi->freq = (uint16_t)(1.0f / tckns * 1000.0f * 2.0f);
 
     // Module Timings
-    uint8_t spd_byte18 = get_spd(slot_idx, 18);
+    uint8_t spd_byte18 = get_cached_spd(slot_idx, 18);
     for (int shft = 0; shft < 7; shft++) {
         if ((spd_byte18 >> shft) & 1) {
             spdi->tCL = 1.0f + shft * 0.5f;
@@ -782,31 +805,31 @@ static void parse_spd_ddr(spd_info *spdi, uint8_t slot_idx)
         }
     }
 
-    tns = (get_spd(slot_idx, 29) >> 2) +
-          (get_spd(slot_idx, 29) & 0x3) * 0.25f;
+    tns = (get_cached_spd(slot_idx, 29) >> 2) +
+          (get_cached_spd(slot_idx, 29) & 0x3) * 0.25f;
     spdi->tRCD = (uint16_t)(tns/tckns + ROUNDING_FACTOR);
 
-    tns = (get_spd(slot_idx, 27) >> 2) +
-          (get_spd(slot_idx, 27) & 0x3) * 0.25f;
+    tns = (get_cached_spd(slot_idx, 27) >> 2) +
+          (get_cached_spd(slot_idx, 27) & 0x3) * 0.25f;
     spdi->tRP = (uint16_t)(tns/tckns + ROUNDING_FACTOR);
 
-    spdi->tRAS = (uint16_t)((float)get_spd(slot_idx, 30)/tckns + ROUNDING_FACTOR);
+    spdi->tRAS = (uint16_t)((float)get_cached_spd(slot_idx, 30)/tckns + ROUNDING_FACTOR);
 
     // Module manufacturer
     uint8_t contcode;
     for (contcode = 64; contcode < 72; contcode++) {
-        if (get_spd(slot_idx, contcode) != 0x7F) {
+        if (get_cached_spd(slot_idx, contcode) != 0x7F) {
             break;
         }
     }
 
     spdi->jedec_code = (contcode - 64) << 8;
-    spdi->jedec_code |= get_spd(slot_idx, contcode) & 0x7F;
+    spdi->jedec_code |= get_cached_spd(slot_idx, contcode) & 0x7F;
 
     read_sku(spdi->sku, slot_idx, 73, 18);
 
-    spdi->fab_year = bcd_to_ui8(get_spd(slot_idx, 93));
-    spdi->fab_week = bcd_to_ui8(get_spd(slot_idx, 94));
+    spdi->fab_year = bcd_to_ui8(get_cached_spd(slot_idx, 93));
+    spdi->fab_week = bcd_to_ui8(get_cached_spd(slot_idx, 94));
 
     spdi->hasTempSensor = false;
 
@@ -818,7 +841,7 @@ static void parse_spd_rdram(spd_info *spdi, uint8_t slot_idx)
     spdi->type = "RDRAM";
 
     // Compute module size in MB
-    uint8_t tbyte = get_spd(slot_idx, 5);
+    uint8_t tbyte = get_cached_spd(slot_idx, 5);
     switch(tbyte) {
         case 0x84:
             spdi->module_size = 8;
@@ -830,17 +853,17 @@ static void parse_spd_rdram(spd_info *spdi, uint8_t slot_idx)
             return;
     }
 
-    spdi->module_size *= get_spd(slot_idx, 99);
+    spdi->module_size *= get_cached_spd(slot_idx, 99);
 
-    tbyte = get_spd(slot_idx, 4);
+    tbyte = get_cached_spd(slot_idx, 4);
     if (tbyte > 0x96) {
         spdi->module_size *= 1 + (((tbyte & 0xF0) >> 4) - 9) + ((tbyte & 0xF) - 6);
     }
 
-    spdi->hasECC = (get_spd(slot_idx, 100) == 0x12) ? true : false;
+    spdi->hasECC = (get_cached_spd(slot_idx, 100) == 0x12) ? true : false;
 
     // Module speed
-    tbyte = get_spd(slot_idx, 15);
+    tbyte = get_cached_spd(slot_idx, 15);
     switch(tbyte) {
         case 0x1A:
             spdi->freq = 600;
@@ -862,26 +885,26 @@ static void parse_spd_rdram(spd_info *spdi, uint8_t slot_idx)
     }
 
     // Module Timings
-    spdi->tCL = get_spd(slot_idx, 14);
-    spdi->tRCD = get_spd(slot_idx, 12);
-    spdi->tRP = get_spd(slot_idx, 10);
-    spdi->tRAS = get_spd(slot_idx, 11);
+    spdi->tCL = get_cached_spd(slot_idx, 14);
+    spdi->tRCD = get_cached_spd(slot_idx, 12);
+    spdi->tRP = get_cached_spd(slot_idx, 10);
+    spdi->tRAS = get_cached_spd(slot_idx, 11);
 
     // Module manufacturer
     uint8_t contcode;
     for (contcode = 64; contcode < 72; contcode++) {
-        if (get_spd(slot_idx, contcode) != 0x7F) {
+        if (get_cached_spd(slot_idx, contcode) != 0x7F) {
             break;
         }
     }
 
     spdi->jedec_code  = ((uint16_t)(contcode - 64)) << 8;
-    spdi->jedec_code |= get_spd(slot_idx, contcode) & 0x7F;
+    spdi->jedec_code |= get_cached_spd(slot_idx, contcode) & 0x7F;
 
     read_sku(spdi->sku, slot_idx, 73, 18);
 
-    spdi->fab_year = bcd_to_ui8(get_spd(slot_idx, 93));
-    spdi->fab_week = bcd_to_ui8(get_spd(slot_idx, 94));
+    spdi->fab_year = bcd_to_ui8(get_cached_spd(slot_idx, 93));
+    spdi->fab_week = bcd_to_ui8(get_cached_spd(slot_idx, 94));
 
     spdi->hasTempSensor = false;
 
@@ -892,10 +915,10 @@ static void parse_spd_sdram(spd_info *spdi, uint8_t slot_idx)
 {
     spdi->type = "SDRAM";
 
-    uint8_t spd_byte3  = get_spd(slot_idx, 3) & 0x0F; // Number of Row Addresses (2 x 4 bits, upper part used if asymmetrical banking used)
-    uint8_t spd_byte4  = get_spd(slot_idx, 4) & 0x0F; // Number of Column Addresses (2 x 4 bits, upper part used if asymmetrical banking used)
-    uint8_t spd_byte5  = get_spd(slot_idx, 5);        // Number of Banks on module (8 bits)
-    uint8_t spd_byte17 = get_spd(slot_idx, 17);       // SDRAM Device Attributes, Number of Banks on the discrete SDRAM Device (8 bits)
+    uint8_t spd_byte3  = get_cached_spd(slot_idx, 3) & 0x0F; // Number of Row Addresses (2 x 4 bits, upper part used if asymmetrical banking used)
+    uint8_t spd_byte4  = get_cached_spd(slot_idx, 4) & 0x0F; // Number of Column Addresses (2 x 4 bits, upper part used if asymmetrical banking used)
+    uint8_t spd_byte5  = get_cached_spd(slot_idx, 5);        // Number of Banks on module (8 bits)
+    uint8_t spd_byte17 = get_cached_spd(slot_idx, 17);       // SDRAM Device Attributes, Number of Banks on the discrete SDRAM Device (8 bits)
 
     // Size in MB
     if (   (spd_byte3 != 0)
@@ -910,46 +933,46 @@ static void parse_spd_sdram(spd_info *spdi, uint8_t slot_idx)
         spdi->module_size = 0;
     }
 
-    spdi->hasECC = ((get_spd(slot_idx, 11) >> 1) == 1);
+    spdi->hasECC = ((get_cached_spd(slot_idx, 11) >> 1) == 1);
 
     // Module speed
     float tns, tckns;
-    uint8_t spd_byte9 = get_spd(slot_idx, 9);
+    uint8_t spd_byte9 = get_cached_spd(slot_idx, 9);
     tckns = (spd_byte9 >> 4) + (spd_byte9 & 0xF) * 0.1f;
 
     spdi->freq = (uint16_t)(1000.0f / tckns);
 
     // Module Timings
-    uint8_t spd_byte18 = get_spd(slot_idx, 18);
+    uint8_t spd_byte18 = get_cached_spd(slot_idx, 18);
     for (int shft = 0; shft < 7; shft++) {
         if ((spd_byte18 >> shft) & 1) {
             spdi->tCL = shft + 1;
         }
     }
 
-    tns = get_spd(slot_idx, 29);
+    tns = get_cached_spd(slot_idx, 29);
     spdi->tRCD = (uint16_t)(tns/tckns + ROUNDING_FACTOR);
 
-    tns = get_spd(slot_idx, 27);
+    tns = get_cached_spd(slot_idx, 27);
     spdi->tRP = (uint16_t)(tns/tckns + ROUNDING_FACTOR);
 
-    spdi->tRAS = (uint16_t)(get_spd(slot_idx, 30)/tckns + ROUNDING_FACTOR);
+    spdi->tRAS = (uint16_t)(get_cached_spd(slot_idx, 30)/tckns + ROUNDING_FACTOR);
 
     // Module manufacturer
     uint8_t contcode;
     for (contcode = 64; contcode < 72; contcode++) {
-        if (get_spd(slot_idx, contcode) != 0x7F) {
+        if (get_cached_spd(slot_idx, contcode) != 0x7F) {
             break;
         }
     }
 
     spdi->jedec_code  = ((uint16_t)(contcode - 64)) << 8;
-    spdi->jedec_code |= get_spd(slot_idx, contcode) & 0x7F;
+    spdi->jedec_code |= get_cached_spd(slot_idx, contcode) & 0x7F;
 
     read_sku(spdi->sku, slot_idx, 73, 18);
 
-    spdi->fab_year = bcd_to_ui8(get_spd(slot_idx, 93));
-    spdi->fab_week = bcd_to_ui8(get_spd(slot_idx, 94));
+    spdi->fab_year = bcd_to_ui8(get_cached_spd(slot_idx, 93));
+    spdi->fab_week = bcd_to_ui8(get_cached_spd(slot_idx, 94));
 
     spdi->hasTempSensor = false;
 
@@ -961,10 +984,13 @@ void parse_spd(spd_info *spdi, uint8_t slot_idx)
     memset(spdi, 0, sizeof(*spdi));     // Also sets isValid to False
     spdi->slot_num = slot_idx;
 
+    // Use a single byte read to check for an empty slot, as that fails quickly.
     if (get_spd(slot_idx, 0) == 0xFF)
         return;
 
-    switch(get_spd(slot_idx, 2))
+    spd_cache_valid[slot_idx] = 0;
+
+    switch(get_cached_spd(slot_idx, 2))
     {
         case 0x12: // DDR5
             parse_spd_ddr5(spdi, slot_idx);
@@ -985,7 +1011,7 @@ void parse_spd(spd_info *spdi, uint8_t slot_idx)
             parse_spd_sdram(spdi, slot_idx);
             break;
         case 0x01: // RAMBUS - RDRAM
-            if (get_spd(slot_idx, 1) == 8) {
+            if (get_cached_spd(slot_idx, 1) == 8) {
                 parse_spd_rdram(spdi, slot_idx);
             }
             break;
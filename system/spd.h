@@ -12,6 +12,7 @@
 
 #define MAX_SPD_SLOT    8
 #define SPD_SKU_LEN     32
+#define SPD_CACHE_SIZE  1024    // DDR5 SPD EEPROM size
 
 /* DDR5 SPD Hub Configuration Registers */
 
@@ -71,4 +72,11 @@ extern ram_slot_info_t ram_slot_info[MAX_SPD_SLOT];
 void print_spdi(spd_info spdi, uint8_t lidx);
 void parse_spd(spd_info *spdi, uint8_t slot_idx);
 
+/**
+ * Returns a byte of SPD data, reading it from the SPD image cached for the
+ * slot, which is filled in using I2C block reads where these are supported.
+ * The cache for a slot is discarded by parse_spd().
+ */
+uint8_t get_cached_spd(uint8_t slot_idx, uint16_t spd_adr);
+
 #endif // SPD_H
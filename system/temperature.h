@@ -49,4 +49,39 @@ int get_cpu_temp(void);
  */
 int get_ram_temp(uint8_t slot);
 
+/**
+ * The number of RAM temperature samples kept for each slot.
+ */
+#define RAM_TEMP_HISTORY_SIZE   64
+
+/**
+ * The interval between samples of each RAM temperature sensor (in ms).
+ */
+#define RAM_TEMP_SAMPLE_PERIOD  1000
+
+/**
+ * The RAM temperature history for a slot.
+ */
+typedef struct {
+    int         min;
+    int         max;
+    int         latest;
+    uint32_t    num_samples;                        // total taken
+    int16_t     samples[RAM_TEMP_HISTORY_SIZE];     // ring indexed by num_samples
+} ram_temp_history_t;
+
+/**
+ * Reads at most one RAM temperature sensor and records the result in the
+ * history for that slot. Successive calls step through the slots that have
+ * a sensor, so each sensor is read once every RAM_TEMP_SAMPLE_PERIOD ms.
+ * Calls made before the next read is due return immediately. Only for DDR5.
+ */
+void sample_ram_temp(void);
+
+/**
+ * Returns the RAM temperature history for the given slot, or NULL if no
+ * samples have been taken.
+ */
+const ram_temp_history_t *get_ram_temp_history(uint8_t slot);
+
 #endif // TEMPERATURE_H
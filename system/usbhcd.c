@@ -1,8 +1,10 @@
 // SPDX-License-Identifier: GPL-2.0
 // Copyright (C) 2021-2022 Martin Whitaker.
 
+#include "heap.h"
 #include "keyboard.h"
 #include "memrw.h"
+#include "memsize.h"
 #include "pci.h"
 #include "screen.h"
 #include "usb.h"
@@ -23,7 +25,7 @@
 // Constants
 //------------------------------------------------------------------------------
 
-#define MAX_HCI                 16      // an arbitrary limit - only affects stack usage
+#define MAX_HCI                 16      // an arbitrary limit - only affects memory usage
 
 #define MAX_HCD                 8       // an arbitrary limit - must match the initialisation of hcd_list
 
@@ -31,6 +33,9 @@
 
 #define MILLISEC                1000    // in microseconds
 
+#define LM_HEAP_RESERVE         SIZE_C(128,KB)  // for deferred initialisation
+#define HM_HEAP_RESERVE         SIZE_C(4,MB)    // for deferred initialisation
+
 //------------------------------------------------------------------------------
 // Types
 //------------------------------------------------------------------------------
@@ -53,6 +58,14 @@ typedef struct {
     uintptr_t       vm_base_addr;
 } hci_info_t;
 
+typedef enum {
+    SEARCH_IDLE,
+    SEARCH_RESET,
+    SEARCH_PROBE_EHCI,
+    SEARCH_PROBE_OTHER,
+    SEARCH_DONE
+} search_state_t;
+
 //------------------------------------------------------------------------------
 // Private Variables
 //------------------------------------------------------------------------------
@@ -85,6 +98,15 @@ static usb_hcd_t hcd_list[MAX_HCD] = {
 
 static int num_hcd = 0;
 
+static hci_info_t hci_list[MAX_HCI];
+
+static int num_hci = 0;
+
+static search_state_t search_state = SEARCH_IDLE;
+static int            search_idx   = 0;
+
+static bool search_deferred = false;
+
 static int print_row = 0;
 static int print_col = 0;
 
@@ -375,9 +397,9 @@ static bool scan_hub_ports(const usb_hcd_t *hcd, const usb_hub_t *hub, int *num_
     return keyboard_found;
 }
 
-static int find_usb_controllers(hci_info_t hci_list[])
+static int find_usb_controllers(hci_info_t hci_table[])
 {
-    int num_hci = 0;
+    int count = 0;
     for (int bus = 0; bus < PCI_MAX_BUS; bus++) {
         for (int dev = 0; dev < PCI_MAX_DEV; dev++) {
             for (int func = 0; func < PCI_MAX_FUNC; func++) {
@@ -390,14 +412,14 @@ static int find_usb_controllers(hci_info_t hci_list[])
                     if (class_code == 0x0c03) {
                         hci_type_t controller_type = pci_config_read8(bus, dev, func, 0x09) >> 4;
                         if (controller_type < MAX_HCI_TYPE) {
-                            hci_list[num_hci].type = controller_type;
-                            hci_list[num_hci].bus  = bus;
-                            hci_list[num_hci].dev  = dev;
-                            hci_list[num_hci].func = func;
-                            num_hci++;
+                            hci_table[count].type = controller_type;
+                            hci_table[count].bus  = bus;
+                            hci_table[count].dev  = dev;
+                            hci_table[count].func = func;
+                            count++;
                             // If we've filled the table, abort now.
-                            if (num_hci == MAX_HCI) {
-                                return num_hci;
+                            if (count == MAX_HCI) {
+                                return count;
                             }
                         }
                     }
@@ -414,7 +436,7 @@ static int find_usb_controllers(hci_info_t hci_list[])
             }
         }
     }
-    return num_hci;
+    return count;
 }
 
 static void reset_usb_controller(hci_info_t *hci)
@@ -557,10 +579,78 @@ static void probe_usb_controller(hci_type_t controller_type, uintptr_t pm_base_a
         break;
     }
     if (keyboards_found) {
+        // The keyboard polling code may run on another CPU core.
+        __sync_synchronize();
         num_hcd++;
     }
 }
 
+static void start_search(void)
+{
+    if ((quirk.type & QUIRK_TYPE_USB) && (quirk.process != NULL)) {
+        quirk.process();
+    }
+
+    num_hci = find_usb_controllers(hci_list);
+
+    num_hcd = 0;
+
+    search_idx   = 0;
+    search_state = SEARCH_RESET;
+}
+
+// Resets or probes at most one controller per call. Returns true when the search is complete.
+static bool search_step(void)
+{
+    while (search_state != SEARCH_DONE) {
+        switch (search_state) {
+          case SEARCH_RESET:
+            // Take ownership of all controllers and reset them.
+            if (search_idx < num_hci) {
+                reset_usb_controller(&hci_list[search_idx++]);
+                return false;
+            }
+            search_idx   = 0;
+            search_state = SEARCH_PROBE_EHCI;
+            break;
+          case SEARCH_PROBE_EHCI:
+            // As we don't support hot plugging, we need to probe EHCI controllers before
+            // probing any of their companion controllers, to ensure any low and full speed
+            // devices are routed to the companion controllers before we probe them.
+            while (search_idx < num_hci && hci_list[search_idx].type != EHCI) {
+                search_idx++;
+            }
+            if (search_idx < num_hci && num_hcd < MAX_HCD) {
+                hci_info_t *hci = &hci_list[search_idx++];
+                if (~usb_init_options & USB_IGNORE_EHCI) {
+                    probe_usb_controller(EHCI, hci->pm_base_addr, hci->vm_base_addr);
+                }
+                hci->type = NOT_HCI;  // prevent this controller from being scanned again
+                return false;
+            }
+            search_idx   = 0;
+            search_state = SEARCH_PROBE_OTHER;
+            break;
+          case SEARCH_PROBE_OTHER:
+            // Now probe the other controllers.
+            while (search_idx < num_hci && hci_list[search_idx].type == NOT_HCI) {
+                search_idx++;
+            }
+            if (search_idx < num_hci && num_hcd < MAX_HCD) {
+                hci_info_t *hci = &hci_list[search_idx++];
+                probe_usb_controller(hci->type, hci->pm_base_addr, hci->vm_base_addr);
+                return false;
+            }
+            search_state = SEARCH_DONE;
+            break;
+          default:
+            search_state = SEARCH_DONE;
+            break;
+        }
+    }
+    return true;
+}
+
 //------------------------------------------------------------------------------
 // Shared Functions (used by all drivers)
 //------------------------------------------------------------------------------
@@ -616,6 +706,11 @@ bool wait_until_set(const volatile uint32_t *reg, uint32_t bit_mask, int max_tim
 
 void print_usb_info(const char *fmt, ...)
 {
+    // The screen belongs to the main display once the tests have started.
+    if (search_deferred) {
+        return;
+    }
+
     if (print_row == SCREEN_HEIGHT) {
         scroll_screen_region(0, 0, SCREEN_HEIGHT - 1, SCREEN_WIDTH - 1);
         print_row--;
@@ -856,39 +951,8 @@ void find_usb_keyboards(bool pause_if_none)
     clear_screen();
     print_usb_info("Scanning for USB keyboards...");
 
-    hci_info_t hci_list[MAX_HCI];
-
-    if ((quirk.type & QUIRK_TYPE_USB) && (quirk.process != NULL)) {
-        quirk.process();
-    }
-
-    int num_hci = find_usb_controllers(hci_list);
-
-    // Take ownership of all controllers and reset them.
-    for (int i = 0; i < num_hci; i++) {
-        reset_usb_controller(&hci_list[i]);
-    }
-
-    num_hcd = 0;
-
-    // As we don't support hot plugging, we need to probe EHCI controllers before
-    // probing any of their companion controllers, to ensure any low and full speed
-    // devices are routed to the companion controllers before we probe them.
-    for (int i = 0; i < num_hci && num_hcd < MAX_HCD; i++) {
-        if (hci_list[i].type == EHCI) {
-            if (~usb_init_options & USB_IGNORE_EHCI) {
-                probe_usb_controller(EHCI, hci_list[i].pm_base_addr, hci_list[i].vm_base_addr);
-            }
-            hci_list[i].type = NOT_HCI;  // prevent this controller from being scanned again
-        }
-    }
-
-    // Now probe the other controllers.
-    for (int i = 0; i < num_hci && num_hcd < MAX_HCD; i++) {
-        if (hci_list[i].type != NOT_HCI) {
-            probe_usb_controller(hci_list[i].type, hci_list[i].pm_base_addr, hci_list[i].vm_base_addr);
-        }
-    }
+    start_search();
+    while (!search_step()) {}
 
     if (usb_init_options & USB_DEBUG) {
         print_usb_info("Press any key to continue...");
@@ -902,6 +966,41 @@ void find_usb_keyboards(bool pause_if_none)
     }
 }
 
+void start_usb_keyboard_search(void)
+{
+    search_deferred = true;
+
+    // The host controller data structures must be excluded from the memory
+    // tests before the tests start.
+    heap_reserve(HEAP_TYPE_LM_1, LM_HEAP_RESERVE);
+    heap_reserve(HEAP_TYPE_HM_1, HM_HEAP_RESERVE);
+
+    start_search();
+
+    // The firmware may still be running a controller's schedule, which could
+    // write to the memory under test, so take ownership of all controllers
+    // and reset them now. Only the probes are deferred.
+    while (search_state == SEARCH_RESET) {
+        search_step();
+    }
+}
+
+bool continue_usb_keyboard_search(void)
+{
+    if (search_state == SEARCH_IDLE) {
+        return true;
+    }
+    if (!search_step()) {
+        return false;
+    }
+    if (search_deferred) {
+        heap_end_reservation(HEAP_TYPE_LM_1);
+        heap_end_reservation(HEAP_TYPE_HM_1);
+        search_deferred = false;
+    }
+    return true;
+}
+
 uint8_t get_usb_keycode(void)
 {
     for (int i = 0; i < num_hcd; i++) {
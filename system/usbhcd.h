@@ -143,7 +143,8 @@ typedef enum {
     USB_2_STEP_INIT     = 1 << 2,
     USB_DEBUG           = 1 << 3,
     USB_DEBUG_HUB       = 1 << 4,
-    USB_DEBUG_KBD       = 1 << 5
+    USB_DEBUG_KBD       = 1 << 5,
+    USB_DEFERRED_INIT   = 1 << 6
 } usb_init_options_t;
 
 /**
@@ -319,6 +320,26 @@ bool process_usb_keyboard_report(const usb_hcd_t *hcd, const hid_kbd_rpt_t *repo
  */
 void find_usb_keyboards(bool pause_if_none);
 
+/**
+ * Starts the same scan as find_usb_keyboards, but returns immediately. The
+ * scan is then carried out one host controller at a time by calls to
+ * continue_usb_keyboard_search. Any keyboards found are available as soon
+ * as their host controller has been probed. Memory for the host controller
+ * drivers is reserved before returning, so the memory tests may be started
+ * before the scan is complete.
+ *
+ * Used internally by keyboard.c.
+ */
+void start_usb_keyboard_search(void);
+
+/**
+ * Carries out the next step of the scan started by start_usb_keyboard_search.
+ * Returns true when the scan is complete.
+ *
+ * Used internally by keyboard.c.
+ */
+bool continue_usb_keyboard_search(void);
+
 /**
  * Polls the keyboards discovered by find_usb_keyboards. Consumes and returns
  * the HID key code for the first key press it detects. Returns zero if no key
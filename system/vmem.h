@@ -63,6 +63,67 @@ uintptr_t map_region(uintptr_t base_addr, size_t size, bool only_for_startup);
  */
 bool map_window(uintptr_t start_page);
 
+/**
+ * Maps a region of physical memory into the area of virtual memory used for
+ * the memory test window, at the given byte offset from the start of that
+ * area. The physical memory region and the offset must be aligned on a \ref
+ * VM_PAGE_SIZE boundary. Only the page table entries covering the region are
+ * changed, so several regions may be mapped at different offsets. The window
+ * must be remapped by a call to map_window() before it is next used.
+ *
+ * \param start_page        - the physical page number of the region.
+ * \param size              - the region size in bytes.
+ * \param offset            - the offset in bytes from the start of the window.
+ *
+ * \returns
+ * On success, the mapped address in virtual memory, On failure, 0.
+ */
+uintptr_t map_window_region(uintptr_t start_page, size_t size, size_t offset);
+
+/**
+ * Programs the page attribute table of the calling CPU core so that regions
+ * passed to set_region_write_combining() use write-combining. This must be
+ * called on each CPU core before it accesses such a region. Does nothing if
+ * the CPU doesn't support PAT.
+ */
+void pat_init(void);
+
+/**
+ * Changes the memory type of a region previously mapped by map_region() to
+ * write-combining. The region must lie in the upper 1GB of virtual memory.
+ * Only the \ref VM_PAGE_SIZE pages that lie wholly within the region are
+ * affected, so the rest of the region keeps its original memory type.
+ *
+ * \param virt_addr         - the virtual address of the region.
+ * \param size              - the region size in bytes.
+ *
+ * \returns
+ * On success, true. On failure (including when no page lies wholly within
+ * the region), false.
+ */
+bool set_region_write_combining(uintptr_t virt_addr, size_t size);
+
+/**
+ * Changes the memory type of the \ref VM_PAGE_SIZE page containing the given
+ * address to uncacheable, or back to the default. The address must lie in
+ * the lower 3GB of virtual memory, and paging must be enabled (which needs
+ * PAE support). The change only takes effect on a CPU core after it calls
+ * flush_tlb(), and the caches should be flushed before the page is accessed
+ * with the new memory type.
+ *
+ * \param addr              - the virtual address.
+ * \param uncached          - true to make the page uncacheable.
+ *
+ * \returns
+ * On success, true. On failure, false.
+ */
+bool set_page_uncached(void *addr, bool uncached);
+
+/**
+ * Flushes the calling CPU core's cached page translations.
+ */
+void flush_tlb(void);
+
 /**
  * Returns a virtual memory pointer to the first word of the specified physical
  * memory page. Physical memory pages above \ref VM_PINNED_SIZE must have been
@@ -48,11 +48,29 @@ void cpuid_init(void)
         cpuid(0x6, 0,
             &cpuid_info.dts_pmp,
             &reg[0],
-            &reg[1],
+            &cpuid_info.pm_caps,
             &reg[2]
         );
     }
 
+    // Check which extended register state the startup code has enabled.
+    if (cpuid_info.flags.osxsave) {
+        uint32_t xcr0_low, xcr0_high;
+        __asm__ __volatile__ ("xgetbv" : "=a" (xcr0_low), "=d" (xcr0_high) : "c" (0));
+        cpuid_info.custom.avx_state    = (xcr0_low & 0x06) == 0x06;
+        cpuid_info.custom.avx512_state = (xcr0_low & 0xe6) == 0xe6;
+    }
+
+    // Get the structured extended feature flags, only save EBX & EDX.
+    if (cpuid_info.max_cpuid >= 7) {
+        cpuid(0x7, 0,
+            &reg[0],
+            &cpuid_info.struct_flags.raw[0],
+            &reg[1],
+            &cpuid_info.struct_flags.raw[1]
+        );
+    }
+
     // Get the max extended cpuid.
     cpuid(0x80000000, 0,
         &cpuid_info.max_xcpuid,
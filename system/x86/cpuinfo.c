@@ -17,6 +17,7 @@
 
 #include "cpuid.h"
 #include "io.h"
+#include "msr.h"
 #include "tsc.h"
 
 #include "boot.h"
@@ -26,6 +27,7 @@
 #include "memctrl.h"
 #include "memsize.h"
 #include "hwquirks.h"
+#include "smp.h"
 
 #include "cpuinfo.h"
 
@@ -38,6 +40,7 @@ const char  *cpu_model = NULL;
 int         l1_cache = 0;
 int         l2_cache = 0;
 int         l3_cache = 0;
+int         l3_cache_threads = 0;
 
 uint32_t    l1_cache_speed  = 0;
 uint32_t    l2_cache_speed  = 0;
@@ -46,6 +49,13 @@ uint32_t    ram_speed = 0;
 
 uint32_t    clks_per_msec = 0;
 
+//------------------------------------------------------------------------------
+// Private Variables
+//------------------------------------------------------------------------------
+
+static uint64_t prev_aperf[MAX_CPUS];
+static uint64_t prev_mperf[MAX_CPUS];
+
 //------------------------------------------------------------------------------
 // Private Functions
 //------------------------------------------------------------------------------
@@ -59,6 +69,21 @@ static void determine_cache_size()
         l2_cache = cpuid_info.cache_info.l2_size;
         l3_cache = cpuid_info.cache_info.l3_size;
         l3_cache *= 512;
+
+        // CPUID(0x8000001D) has the same format as the Intel CPUID(4).
+        if (cpuid_info.max_xcpuid >= 0x8000001D) {
+            for (int i = 0; i < 8; i++) {
+                cpuid4_eax_t eax;
+                uint32_t     dummy;
+                cpuid(0x8000001D, i, &eax.raw, &dummy, &dummy, &dummy);
+                if (eax.ctype == 0) {
+                    break;
+                }
+                if (eax.level == 3) {
+                    l3_cache_threads = eax.num_threads_sharing + 1;
+                }
+            }
+        }
         break;
       case 'C':
         if (cpuid_info.vendor_id.str[5] == 'I') {
@@ -145,6 +170,7 @@ static void determine_cache_size()
                         break;
                       case 3:
                         l3_cache += size;
+                        l3_cache_threads = eax.num_threads_sharing + 1;
                         break;
                       default:
                         break;
@@ -1165,3 +1191,39 @@ void cpuinfo_init(void)
 
     determine_cpu_model();
 }
+
+uint32_t get_effective_cpu_freq(void)
+{
+    if (cpuid_info.max_cpuid < 6 || !(cpuid_info.pm_caps & 1) || clks_per_msec == 0) {
+        return 0;
+    }
+
+    uint32_t lo, hi;
+    rdmsr(MSR_IA32_APERF, lo, hi);
+    uint64_t aperf = (uint64_t)hi << 32 | lo;
+    rdmsr(MSR_IA32_MPERF, lo, hi);
+    uint64_t mperf = (uint64_t)hi << 32 | lo;
+
+    // The counters are per core, so keep the previous values for each core.
+    int my_cpu = smp_my_cpu_num();
+    uint64_t aperf_delta = aperf - prev_aperf[my_cpu];
+    uint64_t mperf_delta = mperf - prev_mperf[my_cpu];
+    bool first_call = (prev_mperf[my_cpu] == 0);
+    prev_aperf[my_cpu] = aperf;
+    prev_mperf[my_cpu] = mperf;
+    if (first_call || mperf_delta == 0) {
+        return 0;
+    }
+
+    // MPERF counts at the TSC rate while the core is in C0, so the ratio gives
+    // the average clock speed over the time the core was active. Scale down
+    // first to avoid overflow when the counters have run for a long time.
+    while (aperf_delta > 0xffffffff || mperf_delta > 0xffffffff) {
+        aperf_delta >>= 1;
+        mperf_delta >>= 1;
+    }
+    if (mperf_delta == 0) {
+        return 0;
+    }
+    return (aperf_delta * (clks_per_msec / 1000)) / mperf_delta;
+}
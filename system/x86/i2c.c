@@ -24,6 +24,7 @@ static uint16_t extra_initial_sleep_for_smb_transaction = 0;
 
 static int8_t spd_page = -1;
 static int8_t last_adr = -1;
+static bool spd_block_failed = false;
 
 // Functions Prototypes
 static bool setup_smb_controller(void);
@@ -36,7 +37,9 @@ static bool piix4_get_smb(uint8_t address);
 static bool ich5_get_smb(void);
 static bool ali_get_smb(uint8_t address);
 static uint8_t ich5_process(void);
+static uint16_t ich5_select_spd_page(uint8_t smbus_adr, uint16_t spd_adr);
 static uint8_t ich5_read_spd_byte(uint8_t adr, uint16_t cmd);
+static bool ich5_read_spd_block(uint8_t smbus_adr, uint16_t spd_adr, uint8_t *buf, uint8_t len);
 static uint8_t nf_read_spd_byte(uint8_t smbus_adr, uint8_t spd_adr);
 static uint8_t ali_m1563_read_spd_byte(uint8_t smbus_adr, uint8_t spd_adr);
 static uint8_t ali_m1543_read_spd_byte(uint8_t smbus_adr, uint8_t spd_adr);
@@ -55,6 +58,8 @@ void print_spd_startup_info(void)
         return;
     }
 
+    uint64_t start_time = get_tsc();
+
     for (spdidx = 0; spdidx < MAX_SPD_SLOT; spdidx++) {
         parse_spd(&curspd, spdidx);
 
@@ -76,6 +81,10 @@ void print_spd_startup_info(void)
         print_spdi(curspd, ROW_SPD+spd_line_idx);
         spd_line_idx++;
     }
+
+    if (spd_line_idx > 0 && clks_per_msec > 0) {
+        printf(ROW_SPD-2, 23, "(read in %ims)", (int)((get_tsc() - start_time) / clks_per_msec));
+    }
 }
 
 // --------------------------
@@ -187,6 +196,16 @@ static const uint16_t intel_ich5_dids[] =
     //0xE422,  // Panther Lake-P (SOC)
 };
 
+// PCI device IDs for Intel i801 SMBus controllers without the I2C block read.
+static const uint16_t intel_pre_ich5_dids[] =
+{
+    0x2413,  // 82801AA (ICH)
+    0x2423,  // 82801AB (ICH)
+    0x2443,  // 82801BA (ICH2)
+    0x2483,  // 82801CA (ICH3)
+    0x24C3,  // 82801DB (ICH4)
+};
+
 static bool find_in_did_array(uint16_t did, const uint16_t * ids, unsigned int size)
 {
     for (unsigned int i = 0; i < size; i++) {
@@ -547,6 +566,27 @@ uint8_t get_spd(uint8_t slot_idx, uint16_t spd_adr)
     }
 }
 
+bool get_spd_block(uint8_t slot_idx, uint16_t spd_adr, uint8_t *buf, uint8_t len)
+{
+    // Only the Intel ICH5 and later controllers support the I2C block read.
+    // A failed transaction takes a long time to time out, so if one fails,
+    // don't try again.
+    if (spd_block_failed || ((smbus_id >> 16) & 0xFFFF) != PCI_VID_INTEL) {
+        return false;
+    }
+    uint16_t did = smbus_id & 0xFFFF;
+    if (!find_in_did_array(did, intel_ich5_dids, ARRAY_SIZE(intel_ich5_dids))
+    ||  find_in_did_array(did, intel_pre_ich5_dids, ARRAY_SIZE(intel_pre_ich5_dids))) {
+        return false;
+    }
+
+    if (!ich5_read_spd_block(slot_idx, spd_adr, buf, len)) {
+        spd_block_failed = true;
+        return false;
+    }
+    return true;
+}
+
 uint8_t get_spd_hub_register(uint8_t slot_idx, uint8_t spd_hub_adr)
 {
     if(dmi_memory_device->type == DMI_DDR5) {
@@ -564,10 +604,9 @@ uint8_t get_spd_hub_register(uint8_t slot_idx, uint8_t spd_hub_adr)
 /                /!\  Your RAM modules will not work anymore  /!\
 / *************************************************************************************/
 
-static uint8_t ich5_read_spd_byte(uint8_t smbus_adr, uint16_t spd_adr)
+// Switches SPD page if needed and returns the I2C byte address on that page.
+static uint16_t ich5_select_spd_page(uint8_t smbus_adr, uint16_t spd_adr)
 {
-    smbus_adr += 0x50;
-
     if (dmi_memory_device->type == DMI_DDR4) {
         // Switch page if needed (DDR4)
         if (spd_adr > 0xFF && spd_page != 1) {
@@ -640,6 +679,15 @@ static uint8_t ich5_read_spd_byte(uint8_t smbus_adr, uint16_t spd_adr)
         }
     }
 
+    return spd_adr;
+}
+
+static uint8_t ich5_read_spd_byte(uint8_t smbus_adr, uint16_t spd_adr)
+{
+    smbus_adr += 0x50;
+
+    spd_adr = ich5_select_spd_page(smbus_adr, spd_adr);
+
     __outb((smbus_adr << 1) | I2C_READ, SMBHSTADD);
     __outb(spd_adr, SMBHSTCMD);
     __outb(SMBHSTCNT_BYTE_DATA, SMBHSTCNT);
@@ -651,6 +699,79 @@ static uint8_t ich5_read_spd_byte(uint8_t smbus_adr, uint16_t spd_adr)
     }
 }
 
+static bool ich5_wait_status(uint8_t wanted)
+{
+    uint16_t timeout = 0;
+    uint8_t status;
+
+    do {
+        usleep(10);
+        status = __inb(SMBHSTSTS);
+    } while (!(status & (wanted | SMBHSTSTS_FAILED | SMBHSTSTS_BUS_ERR | SMBHSTSTS_DEV_ERR)) && (timeout++ < 5000));
+
+    return (status & wanted) && !(status & (SMBHSTSTS_FAILED | SMBHSTSTS_BUS_ERR | SMBHSTSTS_DEV_ERR));
+}
+
+static bool ich5_read_spd_block(uint8_t smbus_adr, uint16_t spd_adr, uint8_t *buf, uint8_t len)
+{
+    smbus_adr += 0x50;
+
+    spd_adr = ich5_select_spd_page(smbus_adr, spd_adr);
+
+    uint8_t status = __inb(SMBHSTSTS) & 0x1F;
+    if (status != 0x00) {
+        __outb(status, SMBHSTSTS);
+        usleep(500);
+        if ((0x1F & __inb(SMBHSTSTS)) != 0x00) {
+            return false;
+        }
+    }
+
+    // Use byte-by-byte mode, not the 32-byte block buffer.
+    __outb(__inb(SMBAUXCTL) & ~SMBAUXCTL_E32B, SMBAUXCTL);
+
+    // The R/W bit must be clear for an I2C block read, unless SPD write
+    // protection is enabled, in which case the controller requires it set.
+    bool spd_wd = pci_config_read8(smbbus, smbdev, smbfun, SMBHSTCFG) & SMBHSTCFG_SPD_WD;
+    __outb((smbus_adr << 1) | (spd_wd ? I2C_READ : I2C_WRITE), SMBHSTADD);
+    __outb(spd_adr, SMBHSTDAT1);
+
+    // The controller reads the next byte as soon as BYTE_DONE is cleared, so
+    // LAST_BYTE must be set before that is done for the second to last byte.
+    uint8_t control = SMBHSTCNT_I2C_BLOCK_DATA;
+    if (len == 1) {
+        control |= SMBHSTCNT_LAST_BYTE;
+    }
+    __outb(control, SMBHSTCNT);
+    __outb(control | SMBHSTCNT_START, SMBHSTCNT);
+
+    bool success = true;
+    for (int i = 0; i < len && success; i++) {
+        success = ich5_wait_status(SMBHSTSTS_BYTE_DONE);
+        if (success) {
+            buf[i] = __inb(SMBBLKDAT);
+        }
+        if (i == len - 2) {
+            control |= SMBHSTCNT_LAST_BYTE;
+            __outb(control, SMBHSTCNT);
+        }
+        __outb(SMBHSTSTS_BYTE_DONE, SMBHSTSTS);
+    }
+
+    if (success) {
+        success = ich5_wait_status(SMBHSTSTS_INTR);
+    } else {
+        // Abort the transaction.
+        __outb(__inb(SMBHSTCNT) | SMBHSTCNT_KILL, SMBHSTCNT);
+        usleep(1000);
+        __outb(__inb(SMBHSTCNT) & ~SMBHSTCNT_KILL, SMBHSTCNT);
+    }
+
+    __outb(__inb(SMBHSTSTS), SMBHSTSTS);
+
+    return success;
+}
+
 static uint8_t ich5_process(void)
 {
     uint8_t status;
@@ -8,13 +8,18 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "boot.h"
+#include "cache.h"
 #include "config.h"
 #include "cpuinfo.h"
 #include "hwquirks.h"
 #include "pmem.h"
+#include "smp.h"
 #include "tsc.h"
 #include "vmem.h"
 
+#include "barrier.h"
+
 #include "display.h"
 
 //------------------------------------------------------------------------------
@@ -32,6 +37,10 @@
 #define COPY_BLOCK_BYTES        4                       // rep movsl works in dwords
 #endif
 
+#define NUMA_BENCH_MAX_DOMAINS  8                       // limited by the window size and the display width
+#define NUMA_BENCH_LEN          SIZE_C(64,MB)           // per proximity domain, a multiple of VM_PAGE_SIZE
+#define NUMA_BENCH_HOPS         (256 * 1024)            // pointer-chasing steps per latency measurement
+
 //------------------------------------------------------------------------------
 // Types
 //------------------------------------------------------------------------------
@@ -43,6 +52,15 @@ typedef enum {
     MEMBENCH_REPMOV   = 3,
 } membench_mode_t;
 
+//------------------------------------------------------------------------------
+// Private Variables
+//------------------------------------------------------------------------------
+
+static uintptr_t numa_bench_page[NUMA_BENCH_MAX_DOMAINS];           // 0 if no buffer was found
+
+static uint32_t  numa_bench_speed[NUMA_BENCH_MAX_DOMAINS][NUMA_BENCH_MAX_DOMAINS];   // CPU domain, memory domain
+static uint32_t  numa_bench_latency[NUMA_BENCH_MAX_DOMAINS][NUMA_BENCH_MAX_DOMAINS]; // in ns
+
 //------------------------------------------------------------------------------
 // Private Functions
 //------------------------------------------------------------------------------
@@ -581,6 +599,123 @@ static void measure_memory_bandwidth(void)
 #endif
 }
 
+static uintptr_t find_numa_bench_region(uint32_t proximity_domain_idx)
+{
+    // Locate a VM page aligned region of free memory that lies entirely within
+    // the proximity domain, avoiding the memory where the program is located.
+    const uintptr_t align         = VM_PAGE_SIZE >> PAGE_SHIFT;
+    const uintptr_t num_pages     = NUMA_BENCH_LEN >> PAGE_SHIFT;
+    const uintptr_t program_start = (uintptr_t)_start >> PAGE_SHIFT;
+    const uintptr_t program_end   = ((uintptr_t)_end + PAGE_SIZE - 1) >> PAGE_SHIFT;
+
+    for (int i = 0; i < pm_map_size; i++) {
+        uintptr_t try_start = pm_map[i].start;
+        if (try_start < (BENCH_MIN_START_ADR >> PAGE_SHIFT)) {
+            try_start = BENCH_MIN_START_ADR >> PAGE_SHIFT;
+        }
+        try_start = align_up_ptr(try_start, align);
+        while (try_start + num_pages <= pm_map[i].end) {
+            uintptr_t try_end = try_start + num_pages;
+            uintptr_t next_start = try_end;
+            if (try_start < program_end && try_end > program_start) {
+                next_start = program_end;
+            } else {
+                uint32_t domain_idx;
+                uint64_t span_start, span_end;
+                if (!smp_narrow_to_proximity_domain((uint64_t)try_start << PAGE_SHIFT, (uint64_t)try_end << PAGE_SHIFT,
+                                                    &domain_idx, &span_start, &span_end)) {
+                    break;
+                }
+                if (domain_idx == proximity_domain_idx && span_end == ((uint64_t)try_end << PAGE_SHIFT)) {
+                    return try_start;
+                }
+                if ((span_end >> PAGE_SHIFT) > try_start) {
+                    next_start = span_end >> PAGE_SHIFT;
+                }
+            }
+            try_start = align_up_ptr(next_start, align);
+        }
+    }
+    return 0;
+}
+
+static void build_chase_chain(uint8_t *buf, size_t len)
+{
+    // Link each cache line to the next in the sequence generated by a full
+    // period LCG, so the hops are not predictable by the hardware prefetchers.
+    // The links are offsets, as each CPU maps the buffer at its own address.
+    const uintptr_t num_lines = len / BENCH_ALIGN;
+    uintptr_t line = 0;
+    for (uintptr_t i = 0; i < num_lines; i++) {
+        uintptr_t next = (line * 1103515245 + 12345) & (num_lines - 1);
+        *(uintptr_t *)(buf + line * BENCH_ALIGN) = next * BENCH_ALIGN;
+        line = next;
+    }
+}
+
+static uint32_t numa_read_speed(const uint8_t *buf, size_t len)
+{
+    const volatile uintptr_t *p   = (const volatile uintptr_t *)buf;
+    const volatile uintptr_t *end = (const volatile uintptr_t *)(buf + len);
+
+    uintptr_t sum = 0;
+    uint64_t start = get_tsc();
+    while (p < end) {
+        sum += p[0] + p[1] + p[2] + p[3] + p[4] + p[5] + p[6] + p[7];
+        p += 8;
+    }
+    uint64_t cycles = get_tsc() - start;
+    __asm__ __volatile__ ("" : : "r" (sum));
+
+    if (cycles == 0) {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)len * clks_per_msec) / cycles);
+}
+
+static uint32_t numa_read_latency(const uint8_t *buf)
+{
+    uintptr_t offset = 0;
+    uint64_t start = get_tsc();
+    for (int i = 0; i < NUMA_BENCH_HOPS; i++) {
+        offset = *(const volatile uintptr_t *)(buf + offset);
+    }
+    uint64_t cycles = get_tsc() - start;
+
+    return (uint32_t)((cycles * 1000000) / ((uint64_t)clks_per_msec * NUMA_BENCH_HOPS));
+}
+
+static bool is_first_cpu_in_domain(int my_cpu, uint32_t proximity_domain_idx)
+{
+    for (int cpu_num = 0; cpu_num < my_cpu; cpu_num++) {
+        if (cpu_state[cpu_num] != CPU_STATE_DISABLED && smp_get_proximity_domain_idx(cpu_num) == proximity_domain_idx) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void display_numa_bench(int num_domains)
+{
+    trace(0, "NUMA read bandwidth (MB/s) / latency (ns), CPU by memory domain");
+    scroll();
+    display_scrolled_message(0, "%s", "mem");
+    for (int to = 0; to < num_domains; to++) {
+        display_scrolled_message(4 + to * 9, "%9i", to);
+    }
+    for (int from = 0; from < num_domains; from++) {
+        scroll();
+        display_scrolled_message(0, "%3i", from);
+        for (int to = 0; to < num_domains; to++) {
+            if (numa_bench_speed[from][to] != 0) {
+                display_scrolled_message(4 + to * 9, "%5i/%3i", (int)(numa_bench_speed[from][to] / 1000), (int)numa_bench_latency[from][to]);
+            } else {
+                display_scrolled_message(4 + to * 9, "%9s", "-");
+            }
+        }
+    }
+}
+
 //------------------------------------------------------------------------------
 // Public Functions
 //------------------------------------------------------------------------------
@@ -595,3 +730,68 @@ void membw_init(void)
         measure_memory_bandwidth();
     }
 }
+
+void membw_numa_init(int my_cpu, barrier_t *barrier)
+{
+    // All the enabled CPUs must call this, as they all wait at the barrier. The
+    // first CPU in each proximity domain measures each domain's memory in turn,
+    // with the domains all running at the same time so the links between them
+    // are loaded as they would be by the memory tests.
+    if (!enable_bench || num_proximity_domains < 2 || clks_per_msec == 0) {
+        return;
+    }
+    int num_domains = num_proximity_domains;
+    if (num_domains > NUMA_BENCH_MAX_DOMAINS) {
+        num_domains = NUMA_BENCH_MAX_DOMAINS;
+    }
+
+    if (my_cpu == 0) {
+        for (int domain_idx = 0; domain_idx < num_domains; domain_idx++) {
+            numa_bench_page[domain_idx] = find_numa_bench_region(domain_idx);
+        }
+    }
+    barrier_spin_wait(barrier);
+
+    uint32_t my_domain = smp_get_proximity_domain_idx(my_cpu);
+    bool i_am_leader = my_domain < (uint32_t)num_domains && is_first_cpu_in_domain(my_cpu, my_domain);
+
+    // Each leader maps the buffer it is measuring into its own slot of the window.
+    size_t my_slot = my_domain * NUMA_BENCH_LEN;
+
+    if (i_am_leader && numa_bench_page[my_domain] != 0) {
+        uint8_t *buf = (uint8_t *)map_window_region(numa_bench_page[my_domain], NUMA_BENCH_LEN, my_slot);
+        if (buf != NULL) {
+            build_chase_chain(buf, NUMA_BENCH_LEN);
+        } else {
+            numa_bench_page[my_domain] = 0;
+        }
+    }
+    barrier_spin_wait(barrier);
+
+    for (int round = 0; round < num_domains; round++) {
+        uint32_t to = (my_domain + round) % num_domains;
+        uint8_t *buf = NULL;
+        if (i_am_leader && numa_bench_page[to] != 0) {
+            buf = (uint8_t *)map_window_region(numa_bench_page[to], NUMA_BENCH_LEN, my_slot);
+            cache_flush();
+        }
+        barrier_spin_wait(barrier);
+        if (buf != NULL) {
+            numa_bench_speed[my_domain][to] = numa_read_speed(buf, NUMA_BENCH_LEN);
+            cache_flush();
+        }
+        barrier_spin_wait(barrier);
+        if (buf != NULL) {
+            numa_bench_latency[my_domain][to] = numa_read_latency(buf);
+        }
+        barrier_spin_wait(barrier);
+    }
+
+    if (my_cpu == 0) {
+        // Restore the initial identity mapping of the window.
+        map_window(PAGE_C(2,GB));
+        if (enable_trace) {
+            display_numa_bench(num_domains);
+        }
+    }
+}
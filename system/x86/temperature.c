@@ -14,9 +14,19 @@
 #include "pci.h"
 #include "smbios.h"
 #include "spd.h"
+#include "tsc.h"
 
 #include "temperature.h"
 
+//------------------------------------------------------------------------------
+// Private Variables
+//------------------------------------------------------------------------------
+
+static ram_temp_history_t ram_temp_history[MAX_SPD_SLOT];
+
+static int      next_sample_slot = 0;
+static uint64_t next_sample_time = 0;   // TSC time stamp
+
 //------------------------------------------------------------------------------
 // Public Variables
 //------------------------------------------------------------------------------
@@ -174,3 +184,51 @@ int get_ram_temp(uint8_t slot)
 
     return ram_temp;
 }
+
+void sample_ram_temp(void)
+{
+    if (dmi_memory_device->type != DMI_DDR5)
+        return;
+
+    int num_sensors = 0;
+    for (int i = 0; i < MAX_SPD_SLOT; i++) {
+        if (ram_slot_info[i].isPopulated && ram_slot_info[i].hasTempSensor)
+            num_sensors++;
+    }
+    if (num_sensors == 0)
+        return;
+
+    if (clks_per_msec > 0) {
+        uint64_t current_time = get_tsc();
+        if (current_time < next_sample_time)
+            return;
+        next_sample_time = current_time + ((uint64_t)RAM_TEMP_SAMPLE_PERIOD * clks_per_msec) / num_sensors;
+    }
+
+    int slot = next_sample_slot;
+    while (!ram_slot_info[slot].isPopulated || !ram_slot_info[slot].hasTempSensor) {
+        slot = (slot + 1) % MAX_SPD_SLOT;
+    }
+    next_sample_slot = (slot + 1) % MAX_SPD_SLOT;
+
+    int ram_temp = get_ram_temp(slot);
+    if (ram_temp == TEMP_INVALID)
+        return;
+
+    ram_temp_history_t *history = &ram_temp_history[slot];
+    if (history->num_samples == 0 || ram_temp < history->min)
+        history->min = ram_temp;
+    if (history->num_samples == 0 || ram_temp > history->max)
+        history->max = ram_temp;
+    history->latest = ram_temp;
+    history->samples[history->num_samples % RAM_TEMP_HISTORY_SIZE] = ram_temp;
+    history->num_samples++;
+}
+
+const ram_temp_history_t *get_ram_temp_history(uint8_t slot)
+{
+    if (slot >= MAX_SPD_SLOT || ram_temp_history[slot].num_samples == 0)
+        return NULL;
+
+    return &ram_temp_history[slot];
+}
@@ -16,6 +16,7 @@
 #include "boot.h"
 
 #include "cpuid.h"
+#include "msr.h"
 
 #include "vmem.h"
 
@@ -37,6 +38,20 @@
 #define VM_REGION_END       (VM_REGION_START + MAX_REGION_PAGES * VM_PAGE_SIZE - 1)
 #define VM_SPACE_END        0xffffffff
 
+// We reprogram PAT entry 4 (selected by the PAT bit in a 2MB page directory
+// entry, with PCD and PWT clear) to give write-combining. By default it gives
+// write-back, the same as entry 0.
+
+#define PAT_WC_ENTRY        4
+#define PAT_TYPE_WC         0x01
+
+#define PDE_PAT_LARGE       0x1000
+
+// Setting both PWT and PCD in a page directory entry selects PAT entry 3,
+// which is uncacheable (UC) by default. This also works without PAT.
+
+#define PDE_UNCACHED        0x18
+
 //------------------------------------------------------------------------------
 // Private Variables
 //------------------------------------------------------------------------------
@@ -140,6 +155,104 @@ bool map_window(uintptr_t start_page)
     return true;
 }
 
+uintptr_t map_window_region(uintptr_t start_page, size_t size, size_t offset)
+{
+    if (cpuid_info.flags.pae == 0) {
+        // No PAE, so we can't change the mapping.
+        return 0;
+    }
+    if (cpuid_info.flags.lm == 0 && (start_page + (size >> PAGE_SHIFT) > PAGE_C(64,GB))) {
+        return 0;
+    }
+    if (offset + size > SIZE_C(1,GB)) {
+        return 0;
+    }
+    uintptr_t first_entry = offset >> VM_PAGE_SHIFT;
+    for (uintptr_t i = 0; i < (size >> VM_PAGE_SHIFT); i++) {
+        pd2[first_entry + i] = ((uint64_t)start_page << PAGE_SHIFT) + ((uint64_t)i << VM_PAGE_SHIFT) + 0x83;
+    }
+    // Reload the PDBR to flush any remnants of the old mapping.
+    load_pdbr();
+
+    return VM_WINDOW_START + offset;
+}
+
+void pat_init(void)
+{
+    if (!cpuid_info.flags.pat) {
+        return;
+    }
+    uint32_t msrl, msrh;
+    rdmsr(MSR_IA32_PAT, msrl, msrh);
+    int shift = (PAT_WC_ENTRY - 4) * 8;
+    msrh = (msrh & ~(0xffu << shift)) | (PAT_TYPE_WC << shift);
+    __asm__ __volatile__ ("wbinvd" : : : "memory");
+    wrmsr(MSR_IA32_PAT, msrl, msrh);
+    // Reload the PDBR to flush any cached translations.
+    load_pdbr();
+}
+
+bool set_region_write_combining(uintptr_t virt_addr, size_t size)
+{
+    if (!cpuid_info.flags.pat || !cpuid_info.flags.pae) {
+        return false;
+    }
+    // Only the device region and the identity mapped region above it can be
+    // changed. Everything below may be RAM that shares the same large page.
+    if (virt_addr < VM_REGION_START || size == 0) {
+        return false;
+    }
+    // Only change the pages that lie wholly within the region, as the others
+    // may also map other devices.
+    uintptr_t first_entry = (virt_addr - VM_REGION_START + VM_PAGE_SIZE - 1) >> VM_PAGE_SHIFT;
+    uintptr_t end_entry   = (virt_addr - VM_REGION_START + size) >> VM_PAGE_SHIFT;
+    if (end_entry <= first_entry) {
+        return false;
+    }
+    for (uintptr_t i = first_entry; i < end_entry; i++) {
+        pd3[i] |= PDE_PAT_LARGE;
+    }
+    // Reload the PDBR to flush any remnants of the old mapping.
+    load_pdbr();
+
+    return true;
+}
+
+bool set_page_uncached(void *addr, bool uncached)
+{
+    // Paging is only enabled when the CPU supports PAE.
+    if (!cpuid_info.flags.pae) {
+        return false;
+    }
+    uint64_t *pd;
+    switch ((uintptr_t)addr >> 30) {
+      case 0:
+        pd = pd0;
+        break;
+      case 1:
+        pd = pd1;
+        break;
+      case 2:
+        pd = pd2;
+        break;
+      default:
+        // The device region mappings must not be changed.
+        return false;
+    }
+    uintptr_t entry = ((uintptr_t)addr >> VM_PAGE_SHIFT) % 512;
+    if (uncached) {
+        pd[entry] |= PDE_UNCACHED;
+    } else {
+        pd[entry] &= ~(uint64_t)PDE_UNCACHED;
+    }
+    return true;
+}
+
+void flush_tlb(void)
+{
+    load_pdbr();
+}
+
 void *first_word_mapping(uintptr_t page)
 {
     void *result;
@@ -4,9 +4,11 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "cpuinfo.h"
 #include "heap.h"
 #include "memrw.h"
 #include "memsize.h"
+#include "tsc.h"
 #include "usb.h"
 #include "vmem.h"
 
@@ -64,6 +66,10 @@
 
 #define XHCI_PORT_SC_PS_OFFSET          10              // first bit of Port Speed
 
+// Event Ring Dequeue Pointer register
+
+#define XHCI_ERDP_EHB                   0x00000008      // Event Handler Busy
+
 // Transfer Request Block data structure
 
 #define XHCI_TRB_ENT                    (1 << 1)        // Evaluate Next TRB
@@ -143,6 +149,8 @@
 
 #define MILLISEC                        1000    // in microseconds
 
+#define MIN_KBD_POLL_PERIOD             1000    // in microseconds
+
 #define DEVICE_WS_SIZE                  (XHCI_MAX_OP_CONTEXT_SIZE + 2 * sizeof(ep_tr_t))
 
 //------------------------------------------------------------------------------
@@ -342,6 +350,10 @@ typedef struct {
 
     // Keyboard endpoint ID lookup table
     uint8_t             kbd_ep_id   [MAX_KEYBOARDS];
+
+    // Keyboard polling schedule.
+    uint32_t            kbd_poll_period;    // in microseconds
+    uint64_t            kbd_next_poll_time; // TSC time stamp
 } workspace_t  __attribute__ ((aligned (64)));
 
 //------------------------------------------------------------------------------
@@ -526,7 +538,7 @@ static void enqueue_xhci_command(workspace_t *ws, uint32_t control, uint64_t par
     ws->cr_enqueue_state = enqueue_trb(ws->cr, WS_CR_SIZE, ws->cr_enqueue_state, control, params1, params2);
 }
 
-static bool get_xhci_event(workspace_t *ws, xhci_trb_t *event)
+static bool next_xhci_event(workspace_t *ws, xhci_trb_t *event)
 {
     // Get the event ring dequeue state, which records the current cycle and next slot to be read.
     uint32_t dequeue_state = ws->er_dequeue_state;
@@ -541,9 +553,6 @@ static bool get_xhci_event(workspace_t *ws, xhci_trb_t *event)
     // If the cycle count doesn't match, that slot hasn't been filled yet.
     if ((event->control & 0x1) != cycle) return false;
 
-    // Advance the dequeue pointer.
-    write64_(&ws->rt_regs->ir[0].erdp, (uintptr_t)(&ws->er[index]));
-
     // Update the event ring dequeue state.
     if (index == (WS_ER_SIZE - 1)) {
         cycle ^= 1;
@@ -556,6 +565,23 @@ static bool get_xhci_event(workspace_t *ws, xhci_trb_t *event)
     return true;
 }
 
+static void update_erdp(workspace_t *ws)
+{
+    // Point the controller at the last slot we have read, and clear the
+    // event handler busy flag.
+    uint32_t index = (ws->er_dequeue_state + WS_ER_SIZE - 1) % WS_ER_SIZE;
+    write64_(&ws->rt_regs->ir[0].erdp, (uintptr_t)(&ws->er[index]) | XHCI_ERDP_EHB);
+}
+
+static bool get_xhci_event(workspace_t *ws, xhci_trb_t *event)
+{
+    if (!next_xhci_event(ws, event)) return false;
+
+    update_erdp(ws);
+
+    return true;
+}
+
 static uint32_t wait_for_xhci_event(workspace_t *ws, uint32_t wanted_type, int max_time, xhci_trb_t *event)
 {
     int timer = max_time >> 3;
@@ -851,6 +877,15 @@ static bool configure_kbd_ep(const usb_hcd_t *hcd, const usb_ep_t *ep, int kbd_i
     ws->kbd_slot_id[kbd_idx] = ep->device_id;
     ws->kbd_ep_id  [kbd_idx] = 2 * ep->endpoint_num + 1;  // EP <N> IN
 
+    // There is no point polling more often than the fastest keyboard sends reports.
+    uint32_t poll_period = 125 << xhci_ep_interval(ep->interval, ep->device_speed);
+    if (poll_period < MIN_KBD_POLL_PERIOD) {
+        poll_period = MIN_KBD_POLL_PERIOD;
+    }
+    if (ws->kbd_poll_period == 0 || poll_period < ws->kbd_poll_period) {
+        ws->kbd_poll_period = poll_period;
+    }
+
     // Configure the controller.
     return configure_interrupt_endpoint(ws, ep, 0, 0, 0, (uintptr_t)(&ws->kbd_tr[kbd_idx]), sizeof(hid_kbd_rpt_t));
 }
@@ -869,9 +904,21 @@ static void poll_keyboards(const usb_hcd_t *hcd)
 {
     workspace_t *ws = (workspace_t *)hcd->ws;
 
+    if (clks_per_msec > 0) {
+        uint64_t current_time = get_tsc();
+        if (current_time < ws->kbd_next_poll_time) return;
+        ws->kbd_next_poll_time = current_time + ((uint64_t)ws->kbd_poll_period * clks_per_msec) / 1000;
+    }
+
+    // Process all pending events before telling the controller, so when no
+    // key has been pressed, we only read the event ring in system memory.
+    bool events_read = false;
+
     xhci_trb_t event;
 
-    while (get_xhci_event(ws, &event)) {
+    while (next_xhci_event(ws, &event)) {
+        events_read = true;
+
         if (event_type(&event) != XHCI_TRB_TRANSFER_EVENT || event_cc(&event) != XHCI_EVENT_CC_SUCCESS) continue;
 
         int kbd_idx = identify_keyboard(ws, event_slot_id(&event), event_ep_id(&event));
@@ -888,6 +935,10 @@ static void poll_keyboards(const usb_hcd_t *hcd)
         issue_normal_trb(kbd_tr, kbd_rpt, XHCI_TRB_DIR_IN, sizeof(hid_kbd_rpt_t));
         ring_device_doorbell(ws->db_regs, ws->kbd_slot_id[kbd_idx], ws->kbd_ep_id[kbd_idx]);
     }
+
+    if (events_read) {
+        update_erdp(ws);
+    }
 }
 
 //------------------------------------------------------------------------------
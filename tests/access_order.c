@@ -0,0 +1,241 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cpuinfo.h"
+#include "dram_map.h"
+#include "vmem.h"
+
+#include "display.h"
+
+#include "access_order.h"
+
+//------------------------------------------------------------------------------
+// Constants
+//------------------------------------------------------------------------------
+
+// The mapping assumed if the DRAM mapping has not been discovered: 8KB of
+// columns (across channels), then 16 banks with no XOR hashing, then rows.
+#define DEFAULT_BANK_SHIFT  13
+#define DEFAULT_BANK_BITS   4
+
+//------------------------------------------------------------------------------
+// Private Variables
+//------------------------------------------------------------------------------
+
+static const char *order_names[NUM_ACCESS_ORDERS] = {
+    "linear",
+    "bank",
+    "conflict",
+    "random"
+};
+
+static uint64_t bank_fn[MAX_DRAM_BANK_FNS];
+static int      num_bank_fns;
+static int      row_line_bit;   // the lowest row bit, as a line index bit
+
+static uint32_t basis[ORDER_WINDOW_BITS];
+static uint32_t pivot[ORDER_WINDOW_BITS];
+static int      basis_size;
+
+//------------------------------------------------------------------------------
+// Public Variables
+//------------------------------------------------------------------------------
+
+uintptr_t order_first = 0;
+uintptr_t order_step[ORDER_WINDOW_BITS];
+
+uint32_t order_bandwidth[NUM_ACCESS_ORDERS];
+
+//------------------------------------------------------------------------------
+// Private Functions
+//------------------------------------------------------------------------------
+
+static inline int highest_bit(uint32_t value)
+{
+    return 31 - __builtin_clz(value);
+}
+
+// Returns the bank number bits that change when the given line index bits
+// are flipped.
+static uint32_t bank_change(uint32_t line_bits)
+{
+    uint64_t addr_bits = (uint64_t)line_bits << ORDER_LINE_SHIFT;
+    uint32_t change = 0;
+    for (int i = 0; i < num_bank_fns; i++) {
+        change |= (uint32_t)__builtin_parityll(addr_bits & bank_fn[i]) << i;
+    }
+    return change;
+}
+
+// Adds v to the basis if it is linearly independent of the vectors already
+// in it.
+static bool add_to_basis(uint32_t v)
+{
+    uint32_t r = v;
+    while (r != 0) {
+        int b = highest_bit(r);
+        if (pivot[b] == 0) {
+            pivot[b] = r;
+            basis[basis_size++] = v;
+            return true;
+        }
+        r ^= pivot[b];
+    }
+    return false;
+}
+
+static void load_bank_fns(void)
+{
+    if (dram_map.valid) {
+        num_bank_fns = dram_map.num_bank_fns;
+        for (int i = 0; i < num_bank_fns; i++) {
+            bank_fn[i] = dram_map.bank_fn[i];
+        }
+        row_line_bit = dram_map.row_shift - ORDER_LINE_SHIFT;
+    } else {
+        num_bank_fns = DEFAULT_BANK_BITS;
+        for (int i = 0; i < num_bank_fns; i++) {
+            bank_fn[i] = (uint64_t)1 << (DEFAULT_BANK_SHIFT + i);
+        }
+        row_line_bit = DEFAULT_BANK_SHIFT + DEFAULT_BANK_BITS - ORDER_LINE_SHIFT;
+    }
+    if (row_line_bit < 0) {
+        row_line_bit = 0;
+    }
+}
+
+// Starts with the line bits that select a different bank, so that successive
+// accesses go to each bank in turn.
+static void add_bank_round_robin(void)
+{
+    uint32_t bank_pivot[MAX_DRAM_BANK_FNS] = { 0 };
+
+    for (int k = 0; k < ORDER_WINDOW_BITS; k++) {
+        uint32_t change = bank_change(1 << k);
+        while (change != 0) {
+            int b = highest_bit(change);
+            if (bank_pivot[b] == 0) {
+                bank_pivot[b] = change;
+                add_to_basis(1 << k);
+                break;
+            }
+            change ^= bank_pivot[b];
+        }
+    }
+}
+
+// Starts with the combinations of row bits that keep the same bank, so that
+// successive accesses go to different rows in the same bank.
+static void add_row_conflict(void)
+{
+    uint32_t bank_pivot[MAX_DRAM_BANK_FNS] = { 0 };
+    uint32_t bank_pivot_bits[MAX_DRAM_BANK_FNS] = { 0 };
+
+    for (int k = row_line_bit; k < ORDER_WINDOW_BITS; k++) {
+        uint32_t v = 1 << k;
+        uint32_t change = bank_change(v);
+        while (change != 0) {
+            int b = highest_bit(change);
+            if (bank_pivot[b] == 0) {
+                bank_pivot[b] = change;
+                bank_pivot_bits[b] = v;
+                break;
+            }
+            change ^= bank_pivot[b];
+            v ^= bank_pivot_bits[b];
+        }
+        if (change == 0) {
+            add_to_basis(v);
+        }
+    }
+}
+
+static void add_random(uint32_t seed)
+{
+    uint32_t state = seed | 1;
+    while (basis_size < ORDER_WINDOW_BITS) {
+        state = state * 1103515245 + 12345;
+        add_to_basis(1 << ((state >> 16) % ORDER_WINDOW_BITS));
+    }
+}
+
+//------------------------------------------------------------------------------
+// Public Functions
+//------------------------------------------------------------------------------
+
+access_order_t access_order_for_pass(int pass)
+{
+    if (access_order == ACCESS_ORDER_CYCLE) {
+        return (access_order_t)(pass % NUM_ACCESS_ORDERS);
+    }
+    return access_order;
+}
+
+const char *access_order_name(access_order_t order)
+{
+    return order < NUM_ACCESS_ORDERS ? order_names[order] : "";
+}
+
+void access_order_select(access_order_t order, uint32_t seed)
+{
+    load_bank_fns();
+
+    for (int k = 0; k < ORDER_WINDOW_BITS; k++) {
+        pivot[k] = 0;
+    }
+    basis_size = 0;
+
+    order_first = 0;
+    switch (order) {
+      case ACCESS_ORDER_BANK:
+        add_bank_round_robin();
+        break;
+      case ACCESS_ORDER_CONFLICT:
+        add_row_conflict();
+        break;
+      case ACCESS_ORDER_RANDOM:
+        add_random(seed);
+        order_first = ((uintptr_t)seed << ORDER_LINE_SHIFT) & (ORDER_WINDOW_SIZE - 1);
+        break;
+      default:
+        break;
+    }
+
+    // Complete the basis in ascending bit order.
+    for (int k = 0; k < ORDER_WINDOW_BITS; k++) {
+        add_to_basis(1 << k);
+    }
+
+    uintptr_t step = 0;
+    for (int k = 0; k < ORDER_WINDOW_BITS; k++) {
+        step ^= (uintptr_t)basis[k] << ORDER_LINE_SHIFT;
+        order_step[k] = step;
+    }
+}
+
+uintptr_t order_windows(testword_t *start, testword_t *end, testword_t **first)
+{
+    // Only the physical address bits within the window size matter here, so
+    // it doesn't matter if the higher bits are lost.
+    uintptr_t phys_offset = ((uintptr_t)page_of(start) << PAGE_SHIFT | ((uintptr_t)start & (PAGE_SIZE - 1))) & (ORDER_WINDOW_SIZE - 1);
+    uintptr_t skip = (ORDER_WINDOW_SIZE - phys_offset) & (ORDER_WINDOW_SIZE - 1);
+    uintptr_t size = (uintptr_t)end - (uintptr_t)start + sizeof(testword_t);
+
+    *first = NULL;
+    if (end < start || size < skip + ORDER_WINDOW_SIZE) {
+        return 0;
+    }
+    *first = (testword_t *)((uintptr_t)start + skip);
+    return (size - skip) >> ORDER_WINDOW_SHIFT;
+}
+
+void access_order_record(access_order_t order, uint64_t bytes, uint64_t clocks)
+{
+    if (order >= NUM_ACCESS_ORDERS || clocks == 0 || clks_per_msec == 0) {
+        return;
+    }
+    order_bandwidth[order] = (bytes * clks_per_msec) / (clocks * 1000);
+    display_test_stage_description("%s order, %u MB/s", order_names[order], (uintptr_t)order_bandwidth[order]);
+}
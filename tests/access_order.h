@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: GPL-2.0
+#ifndef ACCESS_ORDER_H
+#define ACCESS_ORDER_H
+/**
+ * \file
+ *
+ * Provides a choice of the order in which a test visits the cache lines
+ * within each (physically aligned) window of memory. Apart from the linear
+ * order, the orders are constructed from the DRAM bank functions found by
+ * dram_map_discover(), or from a typical mapping if those are not known.
+ *
+ * Each order is a linear mapping over GF(2) from the line index to the line
+ * offset in the window, so it visits every line exactly once and can be
+ * stepped forwards or backwards with a single XOR per line.
+ */
+
+#include <stdint.h>
+
+#include "config.h"
+#include "test.h"
+
+/**
+ * The number of distinct access orders (excluding ACCESS_ORDER_CYCLE).
+ */
+#define NUM_ACCESS_ORDERS       ACCESS_ORDER_CYCLE
+
+/**
+ * The window size (as a power of 2, in bytes) and line size (likewise).
+ * Any part of a block that is not covered by a whole window is visited in
+ * linear order.
+ */
+#define ORDER_WINDOW_SHIFT      24
+#define ORDER_LINE_SHIFT        6
+
+#define ORDER_WINDOW_BITS       (ORDER_WINDOW_SHIFT - ORDER_LINE_SHIFT)
+#define ORDER_WINDOW_SIZE       ((uintptr_t)1 << ORDER_WINDOW_SHIFT)
+#define ORDER_LINE_WORDS        ((1 << ORDER_LINE_SHIFT) / sizeof(testword_t))
+
+/**
+ * The offset (in bytes) of the first line visited in each window.
+ */
+extern uintptr_t order_first;
+
+/**
+ * The offset changes (in bytes) to apply when stepping from line index
+ * i - 1 to line index i, indexed by the number of trailing zeros in i.
+ */
+extern uintptr_t order_step[ORDER_WINDOW_BITS];
+
+/**
+ * The most recently measured bandwidth (in MB/s) for each access order,
+ * or 0 if not yet measured.
+ */
+extern uint32_t order_bandwidth[NUM_ACCESS_ORDERS];
+
+/**
+ * Returns the access order to use in the given pass, taking account of the
+ * ACCESS_ORDER_CYCLE setting.
+ */
+access_order_t access_order_for_pass(int pass);
+
+/**
+ * Returns a short name for the given access order.
+ */
+const char *access_order_name(access_order_t order);
+
+/**
+ * Sets up order_first and order_step for the given order. Must be called
+ * by the master CPU before the test threads use them. The seed is used to
+ * randomise ACCESS_ORDER_RANDOM.
+ */
+void access_order_select(access_order_t order, uint32_t seed);
+
+/**
+ * Records a bandwidth measurement of the given number of bytes read and
+ * written in the given number of TSC clocks using the given order.
+ */
+void access_order_record(access_order_t order, uint64_t bytes, uint64_t clocks);
+
+/**
+ * Returns the number of whole windows in the range of words from start to
+ * end, which must be physically contiguous, and sets *first to point to the
+ * first of them. Sets *first to NULL if there are none.
+ */
+uintptr_t order_windows(testword_t *start, testword_t *end, testword_t **first);
+
+/**
+ * Returns the offset of the first line to visit when walking a window
+ * downwards (the last line visited when walking it upwards).
+ */
+static inline uintptr_t order_last(void)
+{
+    return order_first ^ order_step[ORDER_WINDOW_BITS - 1];
+}
+
+/**
+ * Returns the offset of line index i given the offset of line index i - 1,
+ * or vice versa.
+ */
+static inline uintptr_t order_next(uintptr_t offset, uintptr_t i)
+{
+    return offset ^ order_step[__builtin_ctzl(i)];
+}
+
+#endif // ACCESS_ORDER_H
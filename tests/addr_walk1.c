@@ -12,8 +12,12 @@
 // Released under version 2 of the Gnu Public License.
 // By Chris Brady
 
+#include <stdbool.h>
 #include <stdint.h>
 
+#include "cache.h"
+#include "vmem.h"
+
 #include "display.h"
 #include "error.h"
 #include "test.h"
@@ -21,6 +25,106 @@
 #include "test_funcs.h"
 #include "test_helper.h"
 
+//------------------------------------------------------------------------------
+// Private Functions
+//------------------------------------------------------------------------------
+
+#if defined(__i386__) || defined(__x86_64__)
+// Changes the memory type of the pages containing the addresses probed when
+// walking the range from pb to pe. Returns false if any page can't be changed.
+static bool set_walk_pages_uncached(uintptr_t pb, uintptr_t pe, bool uncached)
+{
+    bool success = set_page_uncached((void *)pb, uncached);
+    uintptr_t mask = sizeof(testword_t);
+    do {
+        uintptr_t p = pb | mask;
+        mask <<= 1;
+        if (p > pe) {
+            break;
+        }
+        if (!set_page_uncached((void *)p, uncached)) {
+            success = false;
+        }
+    } while (mask);
+
+    return success;
+}
+#endif
+
+// Makes the pages containing the addresses probed by each CPU uncacheable (or
+// restores them), so that the probes reach memory without disabling the
+// caches for everything else. Each CPU changes the pages for its own chunks,
+// and the master also changes those for the whole segments, then all the CPUs
+// flush their TLBs and caches. Returns false if any page can't be changed.
+static bool set_probe_pages_uncached(int my_cpu, bool uncached)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    bool success = true;
+
+    sync_test_cpus(my_cpu);
+    for (int j = 0; j < vm_map_size; j++) {
+        testword_t *start, *end;
+        calculate_chunk(&start, &end, my_cpu, j, sizeof(testword_t));
+        if (end >= start) {
+            if (!set_walk_pages_uncached((uintptr_t)start, (uintptr_t)end, uncached)) {
+                success = false;
+            }
+        }
+        if (my_cpu == master_cpu) {
+            if (!set_walk_pages_uncached((uintptr_t)vm_map[j].start, (uintptr_t)vm_map[j].end, uncached)) {
+                success = false;
+            }
+        }
+    }
+    sync_test_cpus(my_cpu);
+    flush_tlb();
+    cache_flush();
+    sync_test_cpus(my_cpu);
+
+    return success;
+#else
+    (void)my_cpu;
+    (void)uncached;
+    return false;
+#endif
+}
+
+static void walk_ones(uintptr_t pb, uintptr_t pe, testword_t invert)
+{
+    // Walking one on our first address.
+    uintptr_t mask1 = sizeof(testword_t);
+    do {
+        testword_t *p1 = (testword_t *)(pb | mask1);
+        mask1 <<= 1;
+        if (p1 > (testword_t *)pe) {
+            break;
+        }
+        testword_t expect = invert ^ (testword_t)p1;
+        write_word(p1, expect);
+
+        // Walking one on our second address.
+        uintptr_t mask2 = sizeof(testword_t);
+        do {
+            testword_t *p2 = (testword_t *)(pb | mask2);
+            mask2 <<= 1;
+            if (p2 == p1) {
+                continue;
+            }
+            if (p2 > (testword_t *)pe) {
+                break;
+            }
+            write_word(p2, ~invert ^ (testword_t)p2);
+
+            testword_t actual = read_word(p1);
+            if (unlikely(actual != expect)) {
+                addr_error(p1, p2, expect, actual);
+                write_word(p1, expect);  // recover from error
+            }
+        } while (mask2);
+
+    } while (mask1);
+}
+
 //------------------------------------------------------------------------------
 // Public Functions
 //------------------------------------------------------------------------------
@@ -32,6 +136,14 @@ int test_addr_walk1(int my_cpu)
     // There isn't a meaningful address for this test.
     test_addr[my_cpu] = 0;
 
+    // If the probed pages can't be made uncacheable, fall back to disabling
+    // the caches on this CPU.
+    bool caches_off = false;
+    if (my_cpu >= 0 && !set_probe_pages_uncached(my_cpu, true)) {
+        cache_off();
+        caches_off = true;
+    }
+
     testword_t invert = 0;
     for (int i = 0; i < 2; i++) {
         if (my_cpu == master_cpu) {
@@ -42,48 +154,37 @@ int test_addr_walk1(int my_cpu)
             continue;
         }
 
+        // Each CPU walks its own chunks in parallel. The high order address
+        // lines don't change within a chunk, so the master then walks each
+        // whole segment while the other CPUs wait.
         for (int j = 0; j < vm_map_size; j++) {
-            uintptr_t pb = (uintptr_t)vm_map[j].start;
-            uintptr_t pe = (uintptr_t)vm_map[j].end;
-
-            // Walking one on our first address.
-            uintptr_t mask1 = sizeof(testword_t);
-            do {
-                testword_t *p1 = (testword_t *)(pb | mask1);
-                mask1 <<= 1;
-                if (p1 > (testword_t *)pe) {
-                    break;
-                }
-                testword_t expect = invert ^ (testword_t)p1;
-                write_word(p1, expect);
-
-                // Walking one on our second address.
-                uintptr_t mask2 = sizeof(testword_t);
-                do {
-                    testword_t *p2 = (testword_t *)(pb | mask2);
-                    mask2 <<= 1;
-                    if (p2 == p1) {
-                        continue;
-                    }
-                    if (p2 > (testword_t *)pe) {
-                        break;
-                    }
-                    write_word(p2, ~invert ^ (testword_t)p2);
-
-                    testword_t actual = read_word(p1);
-                    if (unlikely(actual != expect)) {
-                        addr_error(p1, p2, expect, actual);
-                        write_word(p1, expect);  // recover from error
-                    }
-                } while (mask2);
-
-            } while (mask1);
+            testword_t *start, *end;
+            calculate_chunk(&start, &end, my_cpu, j, sizeof(testword_t));
+            if (end >= start) {
+                walk_ones((uintptr_t)start, (uintptr_t)end, invert);
+            }
+        }
+        sync_test_cpus(my_cpu);
+        if (my_cpu == master_cpu) {
+            for (int j = 0; j < vm_map_size; j++) {
+                walk_ones((uintptr_t)vm_map[j].start, (uintptr_t)vm_map[j].end, invert);
+            }
         }
+        sync_test_cpus(my_cpu);
 
         invert = ~invert;
 
         do_tick(my_cpu);
-        BAILOUT;
+        if (bail) {
+            break;  // but restore the page mappings first
+        }
+    }
+
+    if (my_cpu >= 0) {
+        set_probe_pages_uncached(my_cpu, false);
+        if (caches_off) {
+            cache_on();
+        }
     }
 
     return ticks;
@@ -0,0 +1,246 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cpuinfo.h"
+#include "smp.h"
+#include "tsc.h"
+
+#include "string.h"
+
+#include "display.h"
+#include "error.h"
+#include "test.h"
+
+#include "copy_engine.h"
+#include "test_funcs.h"
+#include "test_helper.h"
+
+//------------------------------------------------------------------------------
+// Private Variables
+//------------------------------------------------------------------------------
+
+static uint64_t stress_bytes[MAX_CPUS];
+static uint64_t stress_clocks[MAX_CPUS];
+
+//------------------------------------------------------------------------------
+// Private Functions
+//------------------------------------------------------------------------------
+
+// Splits the range of words from p to pe into two halves, each a multiple of
+// 8 words, and returns the length of each half.
+static size_t half_length(testword_t *p, testword_t *pe)
+{
+    return ((pe - p + 1) / 2) & ~(size_t)7;
+}
+
+// Appends " <domain>:<bandwidth>" to the text of the given length, if there
+// is room for it in the buffer of the given size, and returns the new length.
+static int append_domain_bandwidth(char *text, int len, int size, int domain, uint32_t bandwidth)
+{
+    char domain_digits[12];
+    char bandwidth_digits[12];
+    itoa(domain, domain_digits);
+    itoa((int)bandwidth, bandwidth_digits);
+
+    int domain_len    = strlen(domain_digits);
+    int bandwidth_len = strlen(bandwidth_digits);
+    if (len + 2 + domain_len + bandwidth_len >= size) {
+        return len;
+    }
+    text[len++] = ' ';
+    memmove(text + len, domain_digits, domain_len);
+    len += domain_len;
+    text[len++] = ':';
+    memmove(text + len, bandwidth_digits, bandwidth_len);
+    len += bandwidth_len;
+    text[len] = '\0';
+    return len;
+}
+
+// Reports the aggregate copy bandwidth achieved by all the CPUs, and that for
+// each proximity domain if there is more than one, as many as fit in place of
+// the pattern. The CPUs all copy at the same time, so the bandwidth is the
+// sum of the per-CPU bandwidths.
+static void report_bandwidth(copy_engine_t engine)
+{
+    char domain_text[SCREEN_WIDTH - 38] = "MB/s by node:";
+    int  domain_text_len = strlen(domain_text);
+
+    uint32_t total = 0;
+    for (int domain = 0; domain < (num_proximity_domains > 1 ? num_proximity_domains : 1); domain++) {
+        uint32_t bandwidth = 0;
+        for (int cpu_num = 0; cpu_num < num_available_cpus; cpu_num++) {
+            if (stress_clocks[cpu_num] == 0) {
+                continue;
+            }
+            if (num_proximity_domains > 1 && smp_get_proximity_domain_idx(cpu_num) != (uint32_t)domain) {
+                continue;
+            }
+            bandwidth += (stress_bytes[cpu_num] * clks_per_msec) / (stress_clocks[cpu_num] * 1000);
+        }
+        if (num_proximity_domains > 1 && bandwidth > 0) {
+            trace(master_cpu, "bandwidth stress: domain %i: %i MB/s", domain, bandwidth);
+            domain_text_len = append_domain_bandwidth(domain_text, domain_text_len, sizeof(domain_text),
+                                                      domain, bandwidth);
+        }
+        total += bandwidth;
+    }
+    if (num_proximity_domains > 1) {
+        display_test_pattern_name(domain_text);
+    }
+    display_test_stage_description("%s copy, %u MB/s", copy_engine_name(engine), (uintptr_t)total);
+}
+
+//------------------------------------------------------------------------------
+// Public Functions
+//------------------------------------------------------------------------------
+
+int test_bandwidth_stress(int my_cpu, int iterations, testword_t pattern, copy_engine_t engine)
+{
+    int ticks = 0;
+
+    bool timed = (clks_per_msec > 0);
+
+    if (my_cpu == master_cpu) {
+        display_test_pattern_name("bandwidth stress");
+        for (int cpu_num = 0; cpu_num < MAX_CPUS; cpu_num++) {
+            stress_bytes[cpu_num]  = 0;
+            stress_clocks[cpu_num] = 0;
+        }
+    }
+
+    // Fill the first half of each block with a pattern that is unique to each
+    // word, so a misdirected copy is detected as well as a corrupted one.
+    for (int i = 0; i < vm_map_size; i++) {
+        testword_t *start, *end;
+        calculate_chunk(&start, &end, my_cpu, i, 16 * sizeof(testword_t));
+        if ((end - start) < 15) SKIP_RANGE(1)  // we need at least 16 words for this test
+
+        testword_t *p  = start;
+        testword_t *pe = start;
+
+        bool at_end = false;
+        do {
+            // take care to avoid pointer overflow
+            if ((end - pe) >= SPIN_SIZE) {
+                pe += SPIN_SIZE - 1;
+            } else {
+                at_end = true;
+                pe = end;
+            }
+            ticks++;
+            if (my_cpu < 0) {
+                continue;
+            }
+            test_addr[my_cpu] = (uintptr_t)p;
+            size_t half = half_length(p, pe);
+            for (size_t j = 0; j < half; j++) {
+                write_word(p + j, pattern ^ (testword_t)(p + j));
+            }
+            p = pe + 1;
+            do_tick(my_cpu);
+            BAILOUT;
+        } while (!at_end && ++pe); // advance pe to next start point
+    }
+
+    flush_caches(my_cpu);
+
+    // Now copy the first half of each block to the second half and back again,
+    // on all CPUs at once, to keep the memory as busy as possible.
+    uint64_t bytes = 0;
+    uint64_t start_time = 0;
+    if (timed) {
+        start_time = get_tsc();
+    }
+
+    for (int i = 0; i < vm_map_size; i++) {
+        testword_t *start, *end;
+        calculate_chunk(&start, &end, my_cpu, i, 16 * sizeof(testword_t));
+        if ((end - start) < 15) SKIP_RANGE(iterations)  // we need at least 16 words for this test
+
+        testword_t *p  = start;
+        testword_t *pe = start;
+
+        bool at_end = false;
+        do {
+            // take care to avoid pointer overflow
+            if ((end - pe) >= SPIN_SIZE) {
+                pe += SPIN_SIZE - 1;
+            } else {
+                at_end = true;
+                pe = end;
+            }
+            size_t half = half_length(p, pe);
+            for (int j = 0; j < iterations; j++) {
+                ticks++;
+                if (my_cpu < 0) {
+                    continue;
+                }
+                test_addr[my_cpu] = (uintptr_t)p;
+                copy_engine_move(engine, p + half, p, half);
+                copy_engine_move(engine, p, p + half, half);
+                bytes += 2 * half * sizeof(testword_t);
+                do_tick(my_cpu);
+                BAILOUT;
+            }
+            p = pe + 1;
+        } while (!at_end && ++pe); // advance pe to next start point
+    }
+
+    if (timed && my_cpu >= 0) {
+        stress_bytes[my_cpu]  = bytes;
+        stress_clocks[my_cpu] = get_tsc() - start_time;
+    }
+
+    flush_caches(my_cpu);
+
+    // The flush synchronises the threads, so all have finished by now.
+    if (timed && my_cpu == master_cpu) {
+        report_bandwidth(engine);
+    }
+
+    // Now check that both halves of each block still hold the pattern.
+    for (int i = 0; i < vm_map_size; i++) {
+        testword_t *start, *end;
+        calculate_chunk(&start, &end, my_cpu, i, 16 * sizeof(testword_t));
+        if ((end - start) < 15) SKIP_RANGE(1)  // we need at least 16 words for this test
+
+        testword_t *p  = start;
+        testword_t *pe = start;
+
+        bool at_end = false;
+        do {
+            // take care to avoid pointer overflow
+            if ((end - pe) >= SPIN_SIZE) {
+                pe += SPIN_SIZE - 1;
+            } else {
+                at_end = true;
+                pe = end;
+            }
+            ticks++;
+            if (my_cpu < 0) {
+                continue;
+            }
+            test_addr[my_cpu] = (uintptr_t)p;
+            size_t half = half_length(p, pe);
+            for (size_t j = 0; j < half; j++) {
+                testword_t expect = pattern ^ (testword_t)(p + j);
+                testword_t actual1 = read_word(p + j);
+                testword_t actual2 = read_word(p + half + j);
+                if (unlikely(actual1 != expect)) {
+                    data_error(p + j, expect, actual1, true);
+                }
+                if (unlikely(actual2 != expect)) {
+                    data_error(p + half + j, expect, actual2, true);
+                }
+            }
+            p = pe + 1;
+            do_tick(my_cpu);
+            BAILOUT;
+        } while (!at_end && ++pe); // advance pe to next start point
+    }
+
+    return ticks;
+}
@@ -15,6 +15,9 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "cpuinfo.h"
+#include "tsc.h"
+
 #include "unistd.h"
 
 #include "display.h"
@@ -24,10 +27,46 @@
 #include "test_funcs.h"
 #include "test_helper.h"
 
+//------------------------------------------------------------------------------
+// Constants
+//------------------------------------------------------------------------------
+
+// Each segment is divided into two halves. The pattern is left to fade in one
+// half, while the other half is tested with moving inversions. The halves are
+// swapped on each pass.
+#define NUM_FADE_REGIONS    2
+
+// The number of words each CPU tests in the other half between each check of
+// the time elapsed.
+#define WORK_UNIT_SIZE      (1 << 20)   // in testwords
+
+//------------------------------------------------------------------------------
+// Types
+//------------------------------------------------------------------------------
+
+typedef struct {
+    int         segment;
+    testword_t  *p;
+    uintptr_t   sweep_words;
+    testword_t  pattern;
+    bool        filled;
+} fade_work_t;
+
+//------------------------------------------------------------------------------
+// Private Variables
+//------------------------------------------------------------------------------
+
+static volatile int fade_secs = 0;
+
 //------------------------------------------------------------------------------
 // Private Functions
 //------------------------------------------------------------------------------
 
+static int fade_region(void)
+{
+    return pass_num % NUM_FADE_REGIONS;
+}
+
 static int pattern_fill(int my_cpu, testword_t pattern)
 {
     int ticks = 0;
@@ -37,8 +76,9 @@ static int pattern_fill(int my_cpu, testword_t pattern)
     }
 
     for (int i = 0; i < vm_map_size; i++) {
-        testword_t *start = vm_map[i].start;
-        testword_t *end   = vm_map[i].end;
+        testword_t *start, *end;
+        calculate_region_chunk(&start, &end, my_cpu, i, fade_region(), NUM_FADE_REGIONS, sizeof(testword_t));
+        if (end < start) SKIP_RANGE(1) // we need at least one word for this test
 
         testword_t *p  = start;
         testword_t *pe = start;
@@ -75,8 +115,9 @@ static int pattern_check(int my_cpu, testword_t pattern)
     int ticks = 0;
 
     for (int i = 0; i < vm_map_size; i++) {
-        testword_t *start = vm_map[i].start;
-        testword_t *end   = vm_map[i].end;
+        testword_t *start, *end;
+        calculate_region_chunk(&start, &end, my_cpu, i, fade_region(), NUM_FADE_REGIONS, sizeof(testword_t));
+        if (end < start) SKIP_RANGE(1) // we need at least one word for this test
 
         testword_t *p  = start;
         testword_t *pe = start;
@@ -109,22 +150,122 @@ static int pattern_check(int my_cpu, testword_t pattern)
     return ticks;
 }
 
+// Tests up to WORK_UNIT_SIZE words of this CPU's chunks of the half of memory
+// that is not fading. The first sweep through the chunks fills them with the
+// pattern. Each later sweep checks for the current pattern and writes its
+// inverse.
+static void fade_work(int my_cpu, fade_work_t *work)
+{
+    uintptr_t remaining = WORK_UNIT_SIZE;
+    while (remaining > 0) {
+        testword_t *start, *end;
+        calculate_region_chunk(&start, &end, my_cpu, work->segment, 1 - fade_region(), NUM_FADE_REGIONS, sizeof(testword_t));
+        if (end >= start) {
+            if (work->p == NULL) {
+                work->p = start;
+            }
+            testword_t *p  = work->p;
+            testword_t *pe = end;
+            if ((uintptr_t)(end - p) >= remaining) {
+                pe = p + remaining - 1;
+            }
+            remaining -= pe - p + 1;
+            work->sweep_words += pe - p + 1;
+
+            test_addr[my_cpu] = (uintptr_t)p;
+            if (work->filled) {
+                testword_t pattern1 = work->pattern;
+                testword_t pattern2 = ~pattern1;
+                do {
+                    testword_t actual = read_word(p);
+                    if (unlikely(actual != pattern1)) {
+                        data_error(p, pattern1, actual, true);
+                    }
+                    write_word(p, pattern2);
+                } while (p++ < pe); // test before increment in case pointer overflows
+            } else {
+                do {
+                    write_word(p, work->pattern);
+                } while (p++ < pe); // test before increment in case pointer overflows
+            }
+            if (pe < end) {
+                work->p = pe + 1;
+                continue;
+            }
+        }
+
+        // Move on to the next segment, ending the sweep if we wrap round.
+        work->p = NULL;
+        if (++work->segment == vm_map_size) {
+            work->segment = 0;
+            if (work->sweep_words == 0) {
+                // This CPU has nothing to test.
+                return;
+            }
+            if (work->filled) {
+                work->pattern = ~work->pattern;
+            }
+            work->filled = true;
+            work->sweep_words = 0;
+        }
+    }
+}
+
+// Waits for sleep_secs, measured by the master CPU. If the TSC is available,
+// the time is used to test the other half of memory, otherwise all CPUs just
+// sleep. Either way, one tick is counted per second.
 static int fade_delay(int my_cpu, int sleep_secs)
 {
     int ticks = 0;
 
+    if (my_cpu < 0 || clks_per_msec == 0) {
+        if (my_cpu == master_cpu) {
+            display_test_stage_description("fade over %i seconds", sleep_secs);
+        }
+        while (sleep_secs > 0) {
+            sleep_secs--;
+            ticks++;
+            if (my_cpu < 0) {
+                continue;
+            }
+            sleep(1);
+            do_tick(my_cpu);
+            BAILOUT;
+        }
+        return ticks;
+    }
+
+    uint64_t start_time = 0;
     if (my_cpu == master_cpu) {
-        display_test_stage_description("fade over %i seconds", sleep_secs);
+        display_test_stage_description("fade over %i s, testing other half", sleep_secs);
+        start_time = get_tsc();
+        fade_secs = 0;
     }
-    while (sleep_secs > 0) {
-        sleep_secs--;
-        ticks++;
-        if (my_cpu < 0) {
-            continue;
+    sync_test_cpus(my_cpu);
+
+#if TESTWORD_WIDTH > 32
+    fade_work_t work = { 0, NULL, 0, UINT64_C(0x5555555555555555), false };
+#else
+    fade_work_t work = { 0, NULL, 0, 0x55555555, false };
+#endif
+    while (true) {
+        fade_work(my_cpu, &work);
+
+        sync_test_cpus(my_cpu);
+        if (my_cpu == master_cpu) {
+            fade_secs = (get_tsc() - start_time) / ((uint64_t)clks_per_msec * 1000);
+        }
+        sync_test_cpus(my_cpu);
+
+        int secs = fade_secs;
+        while (ticks < secs && ticks < sleep_secs) {
+            ticks++;
+            do_tick(my_cpu);
+            BAILOUT;
+        }
+        if (secs >= sleep_secs) {
+            break;
         }
-        sleep(1);
-        do_tick(my_cpu);
-        BAILOUT;
     }
 
     return ticks;
@@ -139,17 +280,21 @@ int test_bit_fade(int my_cpu, int stage, int sleep_secs)
     const testword_t all_zero = 0;
     const testword_t all_ones = ~all_zero;
 
-    static int last_stage = -1;
+    // Each CPU keeps its own record, as they may not all have updated it
+    // before the others check it.
+    static int last_stage[MAX_CPUS];
 
     int ticks = 0;
 
+    int *my_last_stage = &last_stage[my_cpu >= 0 ? my_cpu : master_cpu];
+
     switch (stage) {
       case 0:
         ticks = pattern_fill(my_cpu, all_zero);
         break;
       case 1:
         // Only sleep once.
-        if (stage != last_stage) {
+        if (stage != *my_last_stage) {
             ticks = fade_delay(my_cpu, sleep_secs);
         }
         break;
@@ -161,7 +306,7 @@ int test_bit_fade(int my_cpu, int stage, int sleep_secs)
         break;
       case 4:
         // Only sleep once.
-        if (stage != last_stage) {
+        if (stage != *my_last_stage) {
             ticks = fade_delay(my_cpu, sleep_secs);
         }
         break;
@@ -171,7 +316,7 @@ int test_bit_fade(int my_cpu, int stage, int sleep_secs)
       default:
         break;
     }
-    last_stage = stage;
+    *my_last_stage = stage;
 
     return ticks;
 }
@@ -17,10 +17,14 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "cpuinfo.h"
+#include "tsc.h"
+
 #include "display.h"
 #include "error.h"
 #include "test.h"
 
+#include "copy_engine.h"
 #include "test_funcs.h"
 #include "test_helper.h"
 
@@ -28,7 +32,7 @@
 // Public Functions
 //------------------------------------------------------------------------------
 
-int test_block_move(int my_cpu, int iterations)
+int test_block_move(int my_cpu, int iterations, copy_engine_t engine)
 {
     int ticks = 0;
 
@@ -86,8 +90,22 @@ int test_block_move(int my_cpu, int iterations)
     }
     flush_caches(my_cpu);
 
+    // Only measure the bandwidth when all the active CPUs are running this
+    // test, as it is calculated from the total memory size.
+    bool timed = (my_cpu == master_cpu && clks_per_msec > 0 && num_cpu_groups == 1);
+
+    uint64_t bytes = 0;
+    uint64_t start_time = 0;
+    if (timed) {
+        for (int i = 0; i < vm_map_size; i++) {
+            bytes += (vm_map[i].end - vm_map[i].start + 1) * sizeof(testword_t);
+        }
+        bytes *= iterations;
+        start_time = get_tsc();
+    }
+
     // Now move the data around. First move the data up half of the segment size
-    // we are testing. Then move the data to the original location + 32 bytes.
+    // we are testing. Then move the data to the original location + 8 words.
     for (int i = 0; i < vm_map_size; i++) {
         testword_t *start, *end;
         calculate_chunk(&start, &end, my_cpu, i, 16 * sizeof(testword_t));
@@ -114,136 +132,20 @@ int test_block_move(int my_cpu, int iterations)
                     continue;
                 }
                 test_addr[my_cpu] = (uintptr_t)p;
-#if defined(__x86_64__)
-                __asm__ __volatile__ (
-                    "cld\n"
-                    "jmp L110\n\t"
-
-                    ".p2align 4,,7\n\t"
-                    "L110:\n\t"
-
-                    // At the end of all this
-                    // - the second half equals the initial value of the first half
-                    // - the first half is right shifted 64-bytes (with wrapping)
-
-                    // Move first half to second half
-                    "movq %1,%%rdi\n\t"     // Destination, pm (mid point)
-                    "movq %0,%%rsi\n\t"     // Source, p (start point)
-                    "movq %2,%%rcx\n\t"     // Length, half_length (size of a half in DWORDS)
-                    "rep\n\t"
-                    "movsq\n\t"
-
-                    // Move the second half, less the last 64 bytes, to the first half, offset plus 64 bytes
-                    "movq %0,%%rdi\n\t"
-                    "addq $64,%%rdi\n\t"    // Destination, p (start-point) plus 32 bytes
-                    "movq %1,%%rsi\n\t"     // Source, pm (mid-point)
-                    "movq %2,%%rcx\n\t"
-                    "subq $8,%%rcx\n\t"     // Length, half_length (size of a half in QWORDS) minus 8 QWORDS (64 bytes)
-                    "rep\n\t"
-                    "movsq\n\t"
-
-                    // Move last 8 QWORDS (64 bytes) of the second half to the start of the first half
-                    "movq %0,%%rdi\n\t"     // Destination, p(start-point)
-                                            // Source, 8 QWORDS from the end of the second half, left over by the last rep/movsl
-                    "movq $8,%%rcx\n\t"     // Length, 8 QWORDS (64 bytes)
-                    "rep\n\t"
-                    "movsq\n\t"
-
-                    :: "g" (p), "g" (pm), "g" (half_length)
-                    : "rdi", "rsi", "rcx"
-                );
-#elif defined(__i386__)
-                __asm__ __volatile__ (
-                    "cld\n"
-                    "jmp L110\n\t"
-
-                    ".p2align 4,,7\n\t"
-                    "L110:\n\t"
 
-                    // At the end of all this
-                    // - the second half equals the initial value of the first half
-                    // - the first half is right shifted 32 bytes (with wrapping)
+                // At the end of all this
+                // - the second half equals the initial value of the first half
+                // - the first half is right shifted 8 words (with wrapping)
 
-                    // Move first half to second half
-                    "movl %1,%%edi\n\t"     // Destination, pm (mid point)
-                    "movl %0,%%esi\n\t"     // Source, p (start point)
-                    "movl %2,%%ecx\n\t"     // Length, half_length (size of a half in DWORDS)
-                    "rep\n\t"
-                    "movsl\n\t"
+                // Move first half to second half.
+                copy_engine_move(engine, pm, p, half_length);
 
-                    // Move the second half, less the last 32 bytes, to the first half, offset plus 32 bytes
-                    "movl %0,%%edi\n\t"
-                    "addl $32,%%edi\n\t"    // Destination, p (start-point) plus 32 bytes
-                    "movl %1,%%esi\n\t"     // Source, pm (mid-point)
-                    "movl %2,%%ecx\n\t"
-                    "subl $8,%%ecx\n\t"     // Length, half_length (size of a half in DWORDS) minus 8 DWORDS (32 bytes)
-                    "rep\n\t"
-                    "movsl\n\t"
+                // Move the second half, less the last 8 words, to the first half, offset plus 8 words.
+                copy_engine_move(engine, p + 8, pm, half_length - 8);
 
-                    // Move last 8 DWORDS (32 bytes) of the second half to the start of the first half
-                    "movl %0,%%edi\n\t"     // Destination, p(start-point)
-                                            // Source, 8 DWORDS from the end of the second half, left over by the last rep/movsl
-                    "movl $8,%%ecx\n\t"     // Length, 8 DWORDS (32 bytes)
-                    "rep\n\t"
-                    "movsl\n\t"
+                // Move the last 8 words of the second half to the start of the first half.
+                copy_engine_move(engine, p, pm + half_length - 8, 8);
 
-                    :: "g" (p), "g" (pm), "g" (half_length)
-                    : "edi", "esi", "ecx"
-                );
-#elif defined(__loongarch_lp64)
-                __asm__ __volatile__ (
-                    "b L110\n"
-
-                    ".p2align 4,,8\n\t"
-                    "L110:\n\t"
-
-                    // At the end of all this
-                    // - the second half equals the initial value of the first half
-                    // - the first half is right shifted 64-bytes (with wrapping)
-
-                    // Move first half to second half
-                    "move $t1, %1\n\t"     // Destination, pm (mid point)
-                    "move $t0, %0\n\t"     // Source, p (start point)
-                    "move $t2, %2\n\t"     // Length, half_length (size of a half in DWORDS)
-                    "first_loop:\n\t"
-                    "ld.d $t3, $t0, 0x0\n\t"
-                    "st.d $t3, $t1, 0x0\n\t"
-                    "addi.d $t0, $t0, 0x8\n\t"
-                    "addi.d $t1, $t1, 0x8\n\t"
-                    "addi.d $t2, $t2, -0x1\n\t"
-                    "bnez $t2, first_loop\n\t"
-
-                    // Move the second half, less the last 64 bytes, to the first half, offset plus 64 bytes
-                    "move $t1, %0\n\t"
-                    "addi.d $t1, $t1, 64\n\t"   // Destination, p (start-point) plus 32 bytes
-                    "move $t0, %1\n\t"           // Source, pm (mid-point)
-                    "move $t2, %2\n\t"
-                    "addi.d $t2, $t2, -0x8\n\t" // Length, half_length (size of a half in QWORDS) minus 8 QWORDS (64 bytes)
-                    "second_loop:\n\t"
-                    "ld.d $t3, $t0, 0x0\n\t"
-                    "st.d $t3, $t1, 0x0\n\t"
-                    "addi.d $t0, $t0, 0x8\n\t"
-                    "addi.d $t1, $t1, 0x8\n\t"
-                    "addi.d $t2, $t2, -0x1\n\t"
-                    "bnez $t2, second_loop\n\t"
-
-
-                    // Move last 8 QWORDS (64 bytes) of the second half to the start of the first half
-                    "move $t1, %0\n\t"       // Destination, p(start-point)
-                                            // Source, 8 QWORDS from the end of the second half, left over by the last rep/movsl
-                    "li.d $t2, 0x8\n\t"
-                    "last_loop:\n\t"
-                    "ld.d $t3, $t0, 0x0\n\t"
-                    "st.d $t3, $t1, 0x0\n\t"
-                    "addi.d $t0, $t0, 0x8\n\t"
-                    "addi.d $t1, $t1, 0x8\n\t"
-                    "addi.d $t2, $t2, -0x1\n\t"
-                    "bnez $t2, last_loop\n\t"
-
-                    :: "r" (p), "r" (pm), "r" (half_length)
-                    : "$t0", "$t1", "$t2", "$t3"
-                );
-#endif
                 do_tick(my_cpu);
                 BAILOUT;
             }
@@ -252,6 +154,11 @@ int test_block_move(int my_cpu, int iterations)
 
     flush_caches(my_cpu);
 
+    // The flush synchronises the threads, so all have finished by now.
+    if (timed) {
+        copy_engine_record(engine, bytes, get_tsc() - start_time);
+    }
+
     // Now check the data. The error checking is rather crude.  We just check that the
     // adjacent words are the same.
     for (int i = 0; i < vm_map_size; i++) {
@@ -0,0 +1,229 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid.h"
+#include "cpuinfo.h"
+#include "smp.h"
+#include "tsc.h"
+
+#include "string.h"
+
+#include "display.h"
+#include "error.h"
+#include "test.h"
+
+#include "test_funcs.h"
+#include "test_helper.h"
+
+//------------------------------------------------------------------------------
+// Constants
+//------------------------------------------------------------------------------
+
+#define NUM_CACHE_LEVELS    3
+
+//------------------------------------------------------------------------------
+// Private Variables
+//------------------------------------------------------------------------------
+
+static uint64_t level_bytes[MAX_CPUS];
+static uint64_t level_clocks[MAX_CPUS];
+
+static uint32_t level_bandwidth[NUM_CACHE_LEVELS];
+static bool     level_failed[NUM_CACHE_LEVELS];
+static bool     level_skipped[NUM_CACHE_LEVELS];
+
+//------------------------------------------------------------------------------
+// Private Functions
+//------------------------------------------------------------------------------
+
+// Returns the size (in words) of the working set each CPU uses to exercise
+// the given cache level (0 = L1), or 0 if that level can't be exercised on
+// its own. The working set fills 3/4 of the CPU's share of the cache, and
+// must be larger than the level below so that it doesn't all fit there.
+static size_t working_set_words(int level)
+{
+    int cache_size[NUM_CACHE_LEVELS] = { l1_cache, l2_cache, l3_cache };
+
+    // The L1 and L2 caches are shared by the hardware threads in each core.
+    // There may be more than one L3 cache (e.g. one per CCD or socket), each
+    // shared by a group of threads, so assume they are all in use.
+    int sharing = 1;
+    if (level < 2) {
+        if (num_active_cpus > 1 && cpuid_info.topology.thread_per_core > 1) {
+            sharing = cpuid_info.topology.thread_per_core;
+        }
+    } else {
+        sharing = num_active_cpus;
+        if (l3_cache_threads > 0 && l3_cache_threads < sharing) {
+            sharing = l3_cache_threads;
+        }
+    }
+
+    size_t size = (size_t)cache_size[level] * 1024 / 4 * 3 / sharing;
+    if (level > 0 && size <= (size_t)cache_size[level - 1] * 1024) {
+        return 0;
+    }
+    return size / sizeof(testword_t);
+}
+
+// Returns a pointer to a working set of the given size within this CPU's
+// chunk of the first segment that is large enough, or NULL if there is none.
+static testword_t *find_working_set(int my_cpu, size_t num_words)
+{
+    for (int i = 0; i < vm_map_size; i++) {
+        testword_t *start, *end;
+        calculate_chunk(&start, &end, my_cpu, i, 64);
+        if (end >= start && (size_t)(end - start + 1) >= num_words) {
+            return start;
+        }
+    }
+    return NULL;
+}
+
+static void check_and_write(int level, testword_t *p, testword_t *pe, testword_t expect, testword_t pattern)
+{
+    do {
+        testword_t actual = read_word(p);
+        if (unlikely(actual != expect)) {
+            level_failed[level] = true;
+            data_error(p, expect, actual, false);
+        }
+        write_word(p, pattern);
+    } while (p++ < pe); // test before increment in case pointer overflows
+}
+
+static void check_and_write_down(int level, testword_t *p, testword_t *ps, testword_t expect, testword_t pattern)
+{
+    do {
+        testword_t actual = read_word(p);
+        if (unlikely(actual != expect)) {
+            level_failed[level] = true;
+            data_error(p, expect, actual, false);
+        }
+        write_word(p, pattern);
+    } while (p-- > ps); // test before decrement in case pointer overflows
+}
+
+// Sums the bandwidths measured by the CPUs, which all ran at the same time.
+static uint32_t total_bandwidth(void)
+{
+    uint32_t bandwidth = 0;
+    for (int cpu_num = 0; cpu_num < num_available_cpus; cpu_num++) {
+        if (level_clocks[cpu_num] > 0) {
+            bandwidth += (level_bytes[cpu_num] * clks_per_msec) / (level_clocks[cpu_num] * 1000);
+        }
+    }
+    return bandwidth;
+}
+
+static void report_results(void)
+{
+    for (int level = 0; level < NUM_CACHE_LEVELS; level++) {
+        if (level_failed[level]) {
+            display_test_stage_description("mismatch in L%i working set", level + 1);
+            return;
+        }
+    }
+    char digits[NUM_CACHE_LEVELS][12];
+    const char *text[NUM_CACHE_LEVELS];
+    for (int level = 0; level < NUM_CACHE_LEVELS; level++) {
+        text[level] = level_skipped[level] ? "skipped" : itoa(level_bandwidth[level], digits[level]);
+    }
+    display_test_stage_description("L1 %s, L2 %s, L3 %s MB/s", text[0], text[1], text[2]);
+}
+
+//------------------------------------------------------------------------------
+// Public Functions
+//------------------------------------------------------------------------------
+
+int test_cache_levels(int my_cpu, int iterations, testword_t pattern1, testword_t pattern2)
+{
+    int ticks = 0;
+
+    if (my_cpu == master_cpu) {
+        display_test_pattern_value(pattern1);
+        for (int cpu_num = 0; cpu_num < MAX_CPUS; cpu_num++) {
+            level_bytes[cpu_num]  = 0;
+            level_clocks[cpu_num] = 0;
+        }
+        for (int level = 0; level < NUM_CACHE_LEVELS; level++) {
+            level_bandwidth[level] = 0;
+            level_failed[level]    = false;
+            level_skipped[level]   = false;
+        }
+    }
+
+    // Each cache level is tested in turn, with all the CPUs running at the
+    // same time, so the shared caches are loaded as they are in normal use.
+    // The working sets are never flushed, so the tests run out of the cache
+    // once the first pass has brought the data in.
+    for (int level = 0; level < NUM_CACHE_LEVELS; level++) {
+        size_t num_words = working_set_words(level);
+
+        testword_t *ps = NULL;
+        testword_t *pe = NULL;
+        if (my_cpu >= 0 && num_words > 0) {
+            ps = find_working_set(my_cpu, num_words);
+            pe = ps + num_words - 1;
+        }
+
+        ticks++;
+        if (my_cpu >= 0) {
+            if (ps != NULL) {
+                test_addr[my_cpu] = (uintptr_t)ps;
+                testword_t *p = ps;
+                do {
+                    write_word(p, pattern1);
+                } while (p++ < pe); // test before increment in case pointer overflows
+            }
+            do_tick(my_cpu);
+            BAILOUT;
+            sync_test_cpus(my_cpu);
+        }
+
+        uint64_t start_time = 0;
+        if (my_cpu >= 0 && clks_per_msec > 0) {
+            start_time = get_tsc();
+        }
+
+        for (int i = 0; i < iterations; i++) {
+            ticks++;
+            if (my_cpu < 0) {
+                continue;
+            }
+            if (ps != NULL) {
+                check_and_write(level, ps, pe, pattern1, pattern2);
+                check_and_write_down(level, pe, ps, pattern2, pattern1);
+            }
+            do_tick(my_cpu);
+            BAILOUT;
+        }
+
+        if (my_cpu < 0) {
+            continue;
+        }
+
+        // Record the bandwidth, counting both the reads and the writes.
+        level_bytes[my_cpu]  = 0;
+        level_clocks[my_cpu] = 0;
+        if (ps != NULL && clks_per_msec > 0) {
+            level_bytes[my_cpu]  = (uint64_t)num_words * sizeof(testword_t) * 4 * iterations;
+            level_clocks[my_cpu] = get_tsc() - start_time;
+        }
+        sync_test_cpus(my_cpu);
+
+        if (my_cpu == master_cpu) {
+            level_bandwidth[level] = total_bandwidth();
+            level_skipped[level]   = (num_words == 0);
+            if (level_failed[level]) {
+                trace(my_cpu, "cache test: mismatch in L%i working set", level + 1);
+            }
+            report_results();
+        }
+    }
+
+    return ticks;
+}
@@ -0,0 +1,257 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid.h"
+#include "cpuinfo.h"
+
+#include "display.h"
+
+#include "copy_engine.h"
+
+//------------------------------------------------------------------------------
+// Constants
+//------------------------------------------------------------------------------
+
+#define BLOCK_WORDS     (64 / sizeof(testword_t))
+
+//------------------------------------------------------------------------------
+// Private Variables
+//------------------------------------------------------------------------------
+
+static const char *engine_names[NUM_COPY_ENGINES] = {
+    "movs",
+    "movsb",
+    "nt",
+    "avx2",
+    "avx512"
+};
+
+//------------------------------------------------------------------------------
+// Public Variables
+//------------------------------------------------------------------------------
+
+uint32_t copy_bandwidth[NUM_COPY_ENGINES];
+
+//------------------------------------------------------------------------------
+// Private Functions
+//------------------------------------------------------------------------------
+
+static void move_words(testword_t *dst, const testword_t *src, size_t num_words)
+{
+    if (num_words == 0) {
+        return;
+    }
+#if defined(__x86_64__)
+    __asm__ __volatile__ (
+        "cld            \n\t"
+        "rep movsq      \n\t"
+        : "+D" (dst), "+S" (src), "+c" (num_words)
+        :
+        : "memory"
+    );
+#elif defined(__i386__)
+    __asm__ __volatile__ (
+        "cld            \n\t"
+        "rep movsl      \n\t"
+        : "+D" (dst), "+S" (src), "+c" (num_words)
+        :
+        : "memory"
+    );
+#elif defined(__loongarch_lp64)
+    __asm__ __volatile__ (
+        "1:                         \n\t"
+        "ld.d   $t0, %1, 0x0        \n\t"
+        "st.d   $t0, %0, 0x0        \n\t"
+        "addi.d %1, %1, 0x8         \n\t"
+        "addi.d %0, %0, 0x8         \n\t"
+        "addi.d %2, %2, -0x1        \n\t"
+        "bnez   %2, 1b              \n\t"
+        : "+r" (dst), "+r" (src), "+r" (num_words)
+        :
+        : "$t0", "memory"
+    );
+#endif
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+static void move_bytes(testword_t *dst, const testword_t *src, size_t num_words)
+{
+    size_t num_bytes = num_words * sizeof(testword_t);
+    __asm__ __volatile__ (
+        "cld            \n\t"
+        "rep movsb      \n\t"
+        : "+D" (dst), "+S" (src), "+c" (num_bytes)
+        :
+        : "memory"
+    );
+}
+#endif
+
+#if defined(__x86_64__)
+static void move_nt(testword_t *dst, const testword_t *src, size_t num_blocks)
+{
+    __asm__ __volatile__ (
+        "1:                             \n\t"
+        "movdqu     0x00(%1), %%xmm0    \n\t"
+        "movdqu     0x10(%1), %%xmm1    \n\t"
+        "movdqu     0x20(%1), %%xmm2    \n\t"
+        "movdqu     0x30(%1), %%xmm3    \n\t"
+        "movntdq    %%xmm0, 0x00(%0)    \n\t"
+        "movntdq    %%xmm1, 0x10(%0)    \n\t"
+        "movntdq    %%xmm2, 0x20(%0)    \n\t"
+        "movntdq    %%xmm3, 0x30(%0)    \n\t"
+        "addq       $64, %1             \n\t"
+        "addq       $64, %0             \n\t"
+        "decq       %2                  \n\t"
+        "jnz        1b                  \n\t"
+        "sfence                         \n\t"
+        : "+r" (dst), "+r" (src), "+r" (num_blocks)
+        :
+        : "xmm0", "xmm1", "xmm2", "xmm3", "memory"
+    );
+}
+
+static void move_avx2(testword_t *dst, const testword_t *src, size_t num_blocks)
+{
+    __asm__ __volatile__ (
+        "1:                             \n\t"
+        "vmovdqu    0x00(%1), %%ymm0    \n\t"
+        "vmovdqu    0x20(%1), %%ymm1    \n\t"
+        "vmovdqu    %%ymm0, 0x00(%0)    \n\t"
+        "vmovdqu    %%ymm1, 0x20(%0)    \n\t"
+        "addq       $64, %1             \n\t"
+        "addq       $64, %0             \n\t"
+        "decq       %2                  \n\t"
+        "jnz        1b                  \n\t"
+        "vzeroupper                     \n\t"
+        : "+r" (dst), "+r" (src), "+r" (num_blocks)
+        :
+        : "xmm0", "xmm1", "memory"
+    );
+}
+
+static void move_avx512(testword_t *dst, const testword_t *src, size_t num_blocks)
+{
+    __asm__ __volatile__ (
+        "1:                             \n\t"
+        "vmovdqu64  (%1), %%zmm0        \n\t"
+        "vmovdqu64  %%zmm0, (%0)        \n\t"
+        "addq       $64, %1             \n\t"
+        "addq       $64, %0             \n\t"
+        "decq       %2                  \n\t"
+        "jnz        1b                  \n\t"
+        "vzeroupper                     \n\t"
+        : "+r" (dst), "+r" (src), "+r" (num_blocks)
+        :
+        : "xmm0", "memory"
+    );
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Public Functions
+//------------------------------------------------------------------------------
+
+bool copy_engine_supported(copy_engine_t engine)
+{
+    switch (engine) {
+      case COPY_ENGINE_MOVS:
+        return true;
+#if defined(__i386__) || defined(__x86_64__)
+      case COPY_ENGINE_MOVSB:
+        return cpuid_info.struct_flags.erms || cpuid_info.struct_flags.fsrm;
+#endif
+#if defined(__x86_64__)
+      case COPY_ENGINE_NT:
+        return cpuid_info.flags.sse2;
+      case COPY_ENGINE_AVX2:
+        return cpuid_info.struct_flags.avx2 && cpuid_info.custom.avx_state;
+      case COPY_ENGINE_AVX512:
+        return cpuid_info.struct_flags.avx512f && cpuid_info.custom.avx512_state;
+#endif
+      default:
+        return false;
+    }
+}
+
+copy_engine_t copy_engine_for_pass(int pass)
+{
+    if (copy_engine == COPY_ENGINE_CYCLE) {
+        // Cycle through the supported engines only.
+        int num_supported = 0;
+        copy_engine_t supported[NUM_COPY_ENGINES];
+        for (int i = 0; i < NUM_COPY_ENGINES; i++) {
+            if (copy_engine_supported((copy_engine_t)i)) {
+                supported[num_supported++] = (copy_engine_t)i;
+            }
+        }
+        return supported[pass % num_supported];
+    }
+    return copy_engine_supported(copy_engine) ? copy_engine : COPY_ENGINE_MOVS;
+}
+
+copy_engine_t copy_engine_widest(void)
+{
+    if (copy_engine_supported(COPY_ENGINE_AVX512)) {
+        return COPY_ENGINE_AVX512;
+    }
+    if (copy_engine_supported(COPY_ENGINE_AVX2)) {
+        return COPY_ENGINE_AVX2;
+    }
+    if (copy_engine_supported(COPY_ENGINE_NT)) {
+        return COPY_ENGINE_NT;
+    }
+    return COPY_ENGINE_MOVS;
+}
+
+const char *copy_engine_name(copy_engine_t engine)
+{
+    return engine < NUM_COPY_ENGINES ? engine_names[engine] : "";
+}
+
+void copy_engine_move(copy_engine_t engine, testword_t *dst, const testword_t *src, size_t num_words)
+{
+#if defined(__x86_64__)
+    size_t num_blocks = num_words / BLOCK_WORDS;
+    if (num_blocks > 0) {
+        switch (engine) {
+          case COPY_ENGINE_NT:
+            move_nt(dst, src, num_blocks);
+            break;
+          case COPY_ENGINE_AVX2:
+            move_avx2(dst, src, num_blocks);
+            break;
+          case COPY_ENGINE_AVX512:
+            move_avx512(dst, src, num_blocks);
+            break;
+          default:
+            num_blocks = 0;
+            break;
+        }
+        dst       += num_blocks * BLOCK_WORDS;
+        src       += num_blocks * BLOCK_WORDS;
+        num_words -= num_blocks * BLOCK_WORDS;
+    }
+#endif
+#if defined(__i386__) || defined(__x86_64__)
+    if (engine == COPY_ENGINE_MOVSB) {
+        move_bytes(dst, src, num_words);
+        return;
+    }
+#else
+    (void)engine;
+#endif
+    move_words(dst, src, num_words);
+}
+
+void copy_engine_record(copy_engine_t engine, uint64_t bytes, uint64_t clocks)
+{
+    if (engine >= NUM_COPY_ENGINES || clocks == 0 || clks_per_msec == 0) {
+        return;
+    }
+    copy_bandwidth[engine] = (bytes * clks_per_msec) / (clocks * 1000);
+    display_test_stage_description("%s copy, %u MB/s", engine_names[engine], (uintptr_t)copy_bandwidth[engine]);
+}
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-2.0
+#ifndef COPY_ENGINE_H
+#define COPY_ENGINE_H
+/**
+ * \file
+ *
+ * Provides a choice of the instructions used to copy blocks of memory in the
+ * block move test. Different CPUs have very different throughput for each of
+ * these, and each exercises a different path through the CPU and memory
+ * controller (e.g. the fast string microcode, full cache line writes, or
+ * write combining buffers). The engines that need CPU support are detected
+ * at run time.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "test.h"
+
+/**
+ * The number of distinct copy engines (excluding COPY_ENGINE_CYCLE).
+ */
+#define NUM_COPY_ENGINES    COPY_ENGINE_CYCLE
+
+/**
+ * The most recently measured copy bandwidth (in MB/s) for each engine, or 0
+ * if not yet measured.
+ */
+extern uint32_t copy_bandwidth[NUM_COPY_ENGINES];
+
+/**
+ * Returns true if the given engine is supported by this CPU.
+ */
+bool copy_engine_supported(copy_engine_t engine);
+
+/**
+ * Returns the copy engine to use in the given pass, taking account of the
+ * COPY_ENGINE_CYCLE setting. Falls back to COPY_ENGINE_MOVS if the selected
+ * engine is not supported.
+ */
+copy_engine_t copy_engine_for_pass(int pass);
+
+/**
+ * Returns the supported copy engine that moves the most data per instruction.
+ */
+copy_engine_t copy_engine_widest(void);
+
+/**
+ * Returns a short name for the given copy engine.
+ */
+const char *copy_engine_name(copy_engine_t engine);
+
+/**
+ * Copies num_words words from src to dst using the given engine. The two
+ * ranges must not overlap. The vector engines copy whole 64 byte blocks and
+ * use the string instructions for any remainder. COPY_ENGINE_NT also needs
+ * dst to be 16 byte aligned.
+ */
+void copy_engine_move(copy_engine_t engine, testword_t *dst, const testword_t *src, size_t num_words);
+
+/**
+ * Records a measurement of the given number of bytes copied in the given
+ * number of TSC clocks using the given engine.
+ */
+void copy_engine_record(copy_engine_t engine, uint64_t bytes, uint64_t clocks);
+
+#endif // COPY_ENGINE_H
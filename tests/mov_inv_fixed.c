@@ -17,20 +17,109 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "cpuinfo.h"
+#include "tsc.h"
+
 #include "display.h"
 #include "error.h"
 #include "test.h"
 
+#include "access_order.h"
 #include "test_funcs.h"
 #include "test_helper.h"
 
 #define HAND_OPTIMISED  1   // Use hand-optimised assembler code for performance.
 
+//------------------------------------------------------------------------------
+// Private Functions
+//------------------------------------------------------------------------------
+
+static void check_and_write_up(testword_t *p, testword_t *pe, testword_t pattern1, testword_t pattern2)
+{
+    do {
+        testword_t actual = read_word(p);
+        if (unlikely(actual != pattern1)) {
+            data_error(p, pattern1, actual, true);
+        }
+        write_word(p, pattern2);
+    } while (p++ < pe); // test before increment in case pointer overflows
+}
+
+static void check_and_write_down(testword_t *p, testword_t *ps, testword_t pattern1, testword_t pattern2)
+{
+    do {
+        testword_t actual = read_word(p);
+        if (unlikely(actual != pattern1)) {
+            data_error(p, pattern1, actual, true);
+        }
+        write_word(p, pattern2);
+    } while (p-- > ps); // test before decrement in case pointer overflows
+}
+
+// As check_and_write_up(), but visits the cache lines within each whole
+// window in the selected access order. The remainder is visited linearly.
+static void check_and_write_up_ordered(testword_t *p, testword_t *pe, testword_t pattern1, testword_t pattern2)
+{
+    testword_t *ws;
+    uintptr_t num_windows = order_windows(p, pe, &ws);
+    if (num_windows == 0) {
+        check_and_write_up(p, pe, pattern1, pattern2);
+        return;
+    }
+    if (ws > p) {
+        check_and_write_up(p, ws - 1, pattern1, pattern2);
+    }
+    for (uintptr_t w = 0; w < num_windows; w++) {
+        uintptr_t base   = (uintptr_t)ws + w * ORDER_WINDOW_SIZE;
+        uintptr_t offset = order_first;
+        for (uintptr_t i = 0; i < ((uintptr_t)1 << ORDER_WINDOW_BITS); i++) {
+            if (i > 0) {
+                offset = order_next(offset, i);
+            }
+            testword_t *pl = (testword_t *)(base + offset);
+            check_and_write_up(pl, pl + ORDER_LINE_WORDS - 1, pattern1, pattern2);
+        }
+    }
+    testword_t *we = (testword_t *)((uintptr_t)ws + num_windows * ORDER_WINDOW_SIZE);
+    if (we <= pe && we > ws) {
+        check_and_write_up(we, pe, pattern1, pattern2);
+    }
+}
+
+// As check_and_write_down(), but visits the cache lines within each whole
+// window in the reverse of the selected access order.
+static void check_and_write_down_ordered(testword_t *p, testword_t *ps, testword_t pattern1, testword_t pattern2)
+{
+    testword_t *ws;
+    uintptr_t num_windows = order_windows(ps, p, &ws);
+    if (num_windows == 0) {
+        check_and_write_down(p, ps, pattern1, pattern2);
+        return;
+    }
+    testword_t *we = (testword_t *)((uintptr_t)ws + num_windows * ORDER_WINDOW_SIZE);
+    if (we <= p && we > ws) {
+        check_and_write_down(p, we, pattern1, pattern2);
+    }
+    for (uintptr_t w = num_windows; w > 0; w--) {
+        uintptr_t base   = (uintptr_t)ws + (w - 1) * ORDER_WINDOW_SIZE;
+        uintptr_t offset = order_last();
+        for (uintptr_t i = ((uintptr_t)1 << ORDER_WINDOW_BITS) - 1; ; i--) {
+            testword_t *pl = (testword_t *)(base + offset);
+            check_and_write_down(pl + ORDER_LINE_WORDS - 1, pl, pattern1, pattern2);
+            if (i == 0) break;
+            offset = order_next(offset, i);
+        }
+    }
+    if (ws > ps) {
+        check_and_write_down(ws - 1, ps, pattern1, pattern2);
+    }
+}
+
 //------------------------------------------------------------------------------
 // Public Functions
 //------------------------------------------------------------------------------
 
-int test_mov_inv_fixed(int my_cpu, int iterations, testword_t pattern1, testword_t pattern2)
+int test_mov_inv_fixed(int my_cpu, int iterations, testword_t pattern1, testword_t pattern2, access_order_t order)
 {
     int ticks = 0;
 
@@ -108,9 +197,27 @@ int test_mov_inv_fixed(int my_cpu, int iterations, testword_t pattern1, testword
 
     // Check for the current pattern and then write the alternate pattern for
     // each memory location. Test from the bottom up and then from the top down.
+    // Only measure the bandwidth when all the active CPUs are running this
+    // test, as it is calculated from the total memory size.
+    bool timed = (my_cpu == master_cpu && clks_per_msec > 0 && num_cpu_groups == 1);
+
+    uint64_t bytes  = 0;
+    uint64_t clocks = 0;
+    if (timed) {
+        for (int j = 0; j < vm_map_size; j++) {
+            bytes += (vm_map[j].end - vm_map[j].start + 1) * sizeof(testword_t);
+        }
+        bytes *= 2 * iterations;  // read and write
+    }
+
     for (int i = 0; i < iterations; i++) {
         flush_caches(my_cpu);
 
+        uint64_t start_time = 0;
+        if (timed) {
+            start_time = get_tsc();
+        }
+
         for (int j = 0; j < vm_map_size; j++) {
             testword_t *start, *end;
             calculate_chunk(&start, &end, my_cpu, j, sizeof(testword_t));
@@ -133,13 +240,12 @@ int test_mov_inv_fixed(int my_cpu, int iterations, testword_t pattern1, testword
                     continue;
                 }
                 test_addr[my_cpu] = (uintptr_t)p;
-                do {
-                    testword_t actual = read_word(p);
-                    if (unlikely(actual != pattern1)) {
-                        data_error(p, pattern1, actual, true);
-                    }
-                    write_word(p, pattern2);
-                } while (p++ < pe); // test before increment in case pointer overflows
+                if (order == ACCESS_ORDER_LINEAR) {
+                    check_and_write_up(p, pe, pattern1, pattern2);
+                } else {
+                    check_and_write_up_ordered(p, pe, pattern1, pattern2);
+                }
+                p = pe + 1;
                 do_tick(my_cpu);
                 BAILOUT;
             } while (!at_end && ++pe); // advance pe to next start point
@@ -147,6 +253,11 @@ int test_mov_inv_fixed(int my_cpu, int iterations, testword_t pattern1, testword
 
         flush_caches(my_cpu);
 
+        // The flush synchronises the threads, so all have finished by now.
+        if (timed) {
+            clocks += get_tsc() - start_time;
+        }
+
         for (int j = vm_map_size - 1; j >= 0; j--) {
             testword_t *start, *end;
             calculate_chunk(&start, &end, my_cpu, j, sizeof(testword_t));
@@ -169,18 +280,22 @@ int test_mov_inv_fixed(int my_cpu, int iterations, testword_t pattern1, testword
                     continue;
                 }
                 test_addr[my_cpu] = (uintptr_t)p;
-                do {
-                    testword_t actual = read_word(p);
-                    if (unlikely(actual != pattern2)) {
-                        data_error(p, pattern2, actual, true);
-                    }
-                    write_word(p, pattern1);
-                } while (p-- > ps); // test before decrement in case pointer overflows
+                if (order == ACCESS_ORDER_LINEAR) {
+                    check_and_write_down(p, ps, pattern2, pattern1);
+                } else {
+                    check_and_write_down_ordered(p, ps, pattern2, pattern1);
+                }
+                p = ps - 1;
                 do_tick(my_cpu);
                 BAILOUT;
             } while (!at_start && --ps); // advance ps to next start point
         }
     }
 
+    // Only the upward passes are timed.
+    if (timed) {
+        access_order_record(order, bytes, clocks);
+    }
+
     return ticks;
 }
@@ -15,6 +15,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "cpuid.h"
 #include "vmem.h"
 
 #include "display.h"
@@ -28,6 +29,170 @@
 // Private Functions
 //------------------------------------------------------------------------------
 
+#if defined(__x86_64__)
+// Returns the number of words in each vector used to fill and check memory.
+static size_t vector_words(void)
+{
+    return (cpuid_info.struct_flags.avx2 && cpuid_info.custom.avx_state) ? 4 : 2;
+}
+
+// Writes num_vectors vectors of words starting at p (which must be aligned
+// to the vector size) with their own address plus offset.
+static void fill_vectors(testword_t *p, size_t num_vectors, size_t words, testword_t offset)
+{
+    testword_t init[4] = { 0 };
+    testword_t step[4] = { 0 };
+    for (size_t i = 0; i < words; i++) {
+        init[i] = (testword_t)(p + i) + offset;
+        step[i] = words * sizeof(testword_t);
+    }
+    if (words == 4) {
+        __asm__ __volatile__ (
+            "vmovdqu    %2, %%ymm0          \n\t"
+            "vmovdqu    %3, %%ymm1          \n\t"
+            "1:                             \n\t"
+            "vmovdqa    %%ymm0, (%0)        \n\t"
+            "vpaddq     %%ymm1, %%ymm0, %%ymm0  \n\t"
+            "addq       $32, %0             \n\t"
+            "decq       %1                  \n\t"
+            "jnz        1b                  \n\t"
+            "vzeroupper                     \n\t"
+            : "+r" (p), "+r" (num_vectors)
+            : "m" (init), "m" (step)
+            : "xmm0", "xmm1", "memory"
+        );
+    } else {
+        __asm__ __volatile__ (
+            "movdqu     %2, %%xmm0          \n\t"
+            "movdqu     %3, %%xmm1          \n\t"
+            "1:                             \n\t"
+            "movdqa     %%xmm0, (%0)        \n\t"
+            "paddq      %%xmm1, %%xmm0      \n\t"
+            "addq       $16, %0             \n\t"
+            "decq       %1                  \n\t"
+            "jnz        1b                  \n\t"
+            : "+r" (p), "+r" (num_vectors)
+            : "m" (init), "m" (step)
+            : "xmm0", "xmm1", "memory"
+        );
+    }
+}
+
+// Checks num_vectors vectors of words starting at p (which must be aligned
+// to the vector size) contain their own address plus offset. Returns a
+// pointer to the first vector that doesn't match, or to the word following
+// the last vector if they all match.
+static testword_t *check_vectors(testword_t *p, size_t num_vectors, size_t words, testword_t offset)
+{
+    testword_t init[4] = { 0 };
+    testword_t step[4] = { 0 };
+    for (size_t i = 0; i < words; i++) {
+        init[i] = (testword_t)(p + i) + offset;
+        step[i] = words * sizeof(testword_t);
+    }
+    if (words == 4) {
+        __asm__ __volatile__ (
+            "vmovdqu    %2, %%ymm0          \n\t"
+            "vmovdqu    %3, %%ymm1          \n\t"
+            "1:                             \n\t"
+            "vpcmpeqq   (%0), %%ymm0, %%ymm2    \n\t"
+            "vpmovmskb  %%ymm2, %%eax       \n\t"
+            "cmpl       $-1, %%eax          \n\t"
+            "jne        2f                  \n\t"
+            "vpaddq     %%ymm1, %%ymm0, %%ymm0  \n\t"
+            "addq       $32, %0             \n\t"
+            "decq       %1                  \n\t"
+            "jnz        1b                  \n\t"
+            "2:                             \n\t"
+            "vzeroupper                     \n\t"
+            : "+r" (p), "+r" (num_vectors)
+            : "m" (init), "m" (step)
+            : "eax", "xmm0", "xmm1", "xmm2", "cc", "memory"
+        );
+    } else {
+        __asm__ __volatile__ (
+            "movdqu     %2, %%xmm0          \n\t"
+            "movdqu     %3, %%xmm1          \n\t"
+            "1:                             \n\t"
+            "movdqa     (%0), %%xmm2        \n\t"
+            "pcmpeqd    %%xmm0, %%xmm2      \n\t"
+            "pmovmskb   %%xmm2, %%eax       \n\t"
+            "cmpl       $0xffff, %%eax      \n\t"
+            "jne        2f                  \n\t"
+            "paddq      %%xmm1, %%xmm0      \n\t"
+            "addq       $16, %0             \n\t"
+            "decq       %1                  \n\t"
+            "jnz        1b                  \n\t"
+            "2:                             \n\t"
+            : "+r" (p), "+r" (num_vectors)
+            : "m" (init), "m" (step)
+            : "eax", "xmm0", "xmm1", "xmm2", "cc", "memory"
+        );
+    }
+    return p;
+}
+#endif
+
+static inline void check_word(testword_t *p, testword_t offset)
+{
+    testword_t expect = (testword_t)p + offset;
+    testword_t actual = read_word(p);
+    if (unlikely(actual != expect)) {
+        data_error(p, expect, actual, true);
+    }
+}
+
+// Writes each word from p to pe inclusive with its own address plus offset.
+static void fill_range(testword_t *p, testword_t *pe, testword_t offset)
+{
+#if defined(__x86_64__)
+    size_t words = vector_words();
+    while (p <= pe) {
+        size_t num_vectors = ((uintptr_t)p % (words * sizeof(testword_t)) == 0) ? (pe - p + 1) / words : 0;
+        if (num_vectors > 0) {
+            fill_vectors(p, num_vectors, words, offset);
+            p += num_vectors * words;
+            continue;
+        }
+        write_word(p, (testword_t)p + offset);
+        p++;
+    }
+#else
+    do {
+        write_word(p, (testword_t)p + offset);
+    } while (p++ < pe); // test before increment in case pointer overflows
+#endif
+}
+
+// Checks each word from p to pe inclusive has its own address plus offset.
+static void check_range(testword_t *p, testword_t *pe, testword_t offset)
+{
+#if defined(__x86_64__)
+    size_t words = vector_words();
+    while (p <= pe) {
+        size_t num_vectors = ((uintptr_t)p % (words * sizeof(testword_t)) == 0) ? (pe - p + 1) / words : 0;
+        if (num_vectors > 0) {
+            testword_t *q = check_vectors(p, num_vectors, words, offset);
+            if (q < p + num_vectors * words) {
+                // Find the mismatched word(s) in this vector.
+                for (size_t i = 0; i < words; i++) {
+                    check_word(q + i, offset);
+                }
+                q += words;
+            }
+            p = q;
+            continue;
+        }
+        check_word(p, offset);
+        p++;
+    }
+#else
+    do {
+        check_word(p, offset);
+    } while (p++ < pe); // test before increment in case pointer overflows
+#endif
+}
+
 static int pattern_fill(int my_cpu, testword_t offset)
 {
     int ticks = 0;
@@ -38,8 +203,9 @@ static int pattern_fill(int my_cpu, testword_t offset)
 
     // Write each address with it's own address.
     for (int i = 0; i < vm_map_size; i++) {
-        testword_t *start = vm_map[i].start;
-        testword_t *end   = vm_map[i].end;
+        testword_t *start, *end;
+        calculate_chunk(&start, &end, my_cpu, i, sizeof(testword_t));
+        if (end < start) SKIP_RANGE(1) // we need at least one word for this test
 
         testword_t *p  = start;
         testword_t *pe = start;
@@ -58,9 +224,8 @@ static int pattern_fill(int my_cpu, testword_t offset)
                 continue;
             }
             test_addr[my_cpu] = (uintptr_t)p;
-            do {
-                write_word(p, (testword_t)p + offset);
-            } while (p++ < pe); // test before increment in case pointer overflows
+            fill_range(p, pe, offset);
+            p = pe + 1;
             do_tick(my_cpu);
             BAILOUT;
         } while (!at_end && ++pe); // advance pe to next start point
@@ -77,8 +242,9 @@ static int pattern_check(int my_cpu, testword_t offset)
 
     // Check each address has its own address.
     for (int i = 0; i < vm_map_size; i++) {
-        testword_t *start = vm_map[i].start;
-        testword_t *end   = vm_map[i].end;
+        testword_t *start, *end;
+        calculate_chunk(&start, &end, my_cpu, i, sizeof(testword_t));
+        if (end < start) SKIP_RANGE(1) // we need at least one word for this test
 
         testword_t *p  = start;
         testword_t *pe = start;
@@ -97,13 +263,8 @@ static int pattern_check(int my_cpu, testword_t offset)
                 continue;
             }
             test_addr[my_cpu] = (uintptr_t)p;
-            do {
-                testword_t expect = (testword_t)p + offset;
-                testword_t actual = read_word(p);
-                if (unlikely(actual != expect)) {
-                    data_error(p, expect, actual, true);
-                }
-            } while (p++ < pe); // test before increment in case pointer overflows
+            check_range(p, pe, offset);
+            p = pe + 1;
             do_tick(my_cpu);
             BAILOUT;
         } while (!at_end && ++pe); // advance pe to next start point
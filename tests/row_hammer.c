@@ -0,0 +1,282 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cpuinfo.h"
+#include "dram_map.h"
+#include "tsc.h"
+#include "vmem.h"
+
+#include "display.h"
+#include "error.h"
+#include "test.h"
+
+#include "test_funcs.h"
+#include "test_helper.h"
+
+//------------------------------------------------------------------------------
+// Constants
+//------------------------------------------------------------------------------
+
+// The DRAM row size is assumed to be 8KB, which is typical for DDR3/4/5
+// DIMMs, unless the DRAM mapping has been discovered. It is only used to
+// count the number of rows containing flipped bits.
+#define ROW_SHIFT           13
+
+// The smallest chunk we will hammer. Smaller chunks are unlikely to contain
+// two different rows in the same bank.
+#define MIN_HAMMER_SIZE     (1 << 22)   // in bytes
+
+// The number of candidate partners tried for each aggressor, and the number
+// of accesses used to time each candidate.
+#define NUM_CANDIDATES      64
+#define NUM_TIMING_READS    16
+
+// The number of times each pair of aggressors is accessed. This is chosen
+// to give well over the typical disturbance threshold within one 64ms
+// refresh interval.
+#define HAMMER_COUNT        (1 << 19)
+
+//------------------------------------------------------------------------------
+// Private Variables
+//------------------------------------------------------------------------------
+
+static uint32_t hammer_rate[MAX_CPUS];  // activations per ms
+static uint32_t flip_count[MAX_CPUS];  // flipped bits
+static uint32_t flip_rows[MAX_CPUS];
+static uint32_t worst_row_flips[MAX_CPUS];
+static uint64_t worst_row_addr[MAX_CPUS];
+
+//------------------------------------------------------------------------------
+// Private Functions
+//------------------------------------------------------------------------------
+
+// Picks the candidate partner for addr1 that has the highest access latency
+// when alternated with it. This is most likely to be a different row in the
+// same bank (a row buffer conflict).
+static testword_t *find_partner(testword_t *addr1, testword_t *start, uintptr_t num_lines, testword_t *prsg_state)
+{
+    testword_t *best_addr = NULL;
+    uint64_t    best_time = 0;
+
+    for (int i = 0; i < NUM_CANDIDATES; i++) {
+        *prsg_state = prsg(*prsg_state);
+        testword_t *addr2 = start + (*prsg_state % num_lines) * (64 / sizeof(testword_t));
+        if (page_of(addr2) == page_of(addr1)) {
+            continue;
+        }
+        uint64_t start_time = get_tsc();
+        dram_access_pair(addr1, addr2, NUM_TIMING_READS);
+        uint64_t time = get_tsc() - start_time;
+        if (time > best_time) {
+            best_time = time;
+            best_addr = addr2;
+        }
+    }
+    return best_addr;
+}
+
+static uint64_t phys_addr_of(const testword_t *addr)
+{
+    return (uint64_t)page_of((void *)addr) << PAGE_SHIFT | ((uintptr_t)addr & (PAGE_SIZE - 1));
+}
+
+// Uses the discovered DRAM mapping to turn the randomly chosen *addr into a
+// victim row with an aggressor row either side of it in the same bank. On
+// success, updates *addr to point to the lower aggressor and returns the
+// upper one. Returns NULL if the aggressors would fall outside the chunk or
+// in a different bank.
+static testword_t *find_double_sided(testword_t **addr, testword_t *start, testword_t *end)
+{
+    uintptr_t row_size = (uintptr_t)1 << dram_map.row_shift;
+    uintptr_t victim   = (uintptr_t)*addr;
+    if (victim - (uintptr_t)start < row_size || (uintptr_t)end - victim < row_size) {
+        return NULL;
+    }
+    testword_t *addr1 = (testword_t *)(victim - row_size);
+    testword_t *addr2 = (testword_t *)(victim + row_size);
+    uint64_t phys1 = phys_addr_of(addr1);
+    uint64_t phys2 = phys_addr_of(addr2);
+    if (!dram_same_bank(phys1, phys2) || dram_row_of(phys1) == dram_row_of(phys2)) {
+        return NULL;
+    }
+    *addr = addr1;
+    return addr2;
+}
+
+// The program isn't linked with libgcc, so __builtin_popcount() can't be used.
+static uint32_t count_bits(testword_t word)
+{
+    uint32_t bits = 0;
+    while (word != 0) {
+        word &= word - 1;
+        bits++;
+    }
+    return bits;
+}
+
+static void display_hammer_stats(void)
+{
+    uint32_t rate  = 0;
+    uint32_t flips = 0;
+    uint32_t rows  = 0;
+    int      worst = 0;
+    for (int i = 0; i < MAX_CPUS; i++) {
+        rate  += hammer_rate[i];
+        flips += flip_count[i];
+        rows  += flip_rows[i];
+        if (worst_row_flips[i] > worst_row_flips[worst]) {
+            worst = i;
+        }
+    }
+    if (flips == 0) {
+        display_test_stage_description("%uK act/s, no flips", rate);
+        return;
+    }
+    // There isn't room for the activation rate as well.
+    display_test_stage_description("%u flips, %u rows, max %u/row", flips, rows, worst_row_flips[worst]);
+    trace(master_cpu, "row hammer: %i flips in worst row at %kB",
+          worst_row_flips[worst], (uintptr_t)(worst_row_addr[worst] >> 10));
+}
+
+//------------------------------------------------------------------------------
+// Public Functions
+//------------------------------------------------------------------------------
+
+int test_row_hammer(int my_cpu, int iterations, testword_t pattern)
+{
+    int ticks = 0;
+
+    if (my_cpu == master_cpu) {
+        display_test_pattern_value(pattern);
+        for (int i = 0; i < MAX_CPUS; i++) {
+            hammer_rate[i] = 0;
+            flip_count[i]      = 0;
+            flip_rows[i]       = 0;
+            worst_row_flips[i] = 0;
+            worst_row_addr[i]  = 0;
+        }
+    }
+
+    testword_t prsg_state = 0x12345678 + pass_num;
+    if (my_cpu >= 0) {
+        prsg_state += get_tsc() + my_cpu;
+    }
+
+    for (int i = 0; i < vm_map_size; i++) {
+        testword_t *start, *end;
+        calculate_chunk(&start, &end, my_cpu, i, 64);
+        if ((uintptr_t)(end - start) < (MIN_HAMMER_SIZE / sizeof(testword_t) - 1)) SKIP_RANGE(1)
+
+        // Fill the chunk with the victim pattern.
+        testword_t *p  = start;
+        testword_t *pe = start;
+
+        bool at_end = false;
+        do {
+            // take care to avoid pointer overflow
+            if ((end - pe) >= SPIN_SIZE) {
+                pe += SPIN_SIZE - 1;
+            } else {
+                at_end = true;
+                pe = end;
+            }
+            ticks++;
+            if (my_cpu < 0) {
+                continue;
+            }
+            test_addr[my_cpu] = (uintptr_t)p;
+            do {
+                write_word(p, pattern);
+            } while (p++ < pe); // test before increment in case pointer overflows
+            do_tick(my_cpu);
+            BAILOUT;
+        } while (!at_end && ++pe); // advance pe to next start point
+
+        flush_caches(my_cpu);
+
+        // Hammer pairs of aggressor rows chosen at random. If the DRAM mapping
+        // is known, hammer the rows either side of a victim row, otherwise pick
+        // the partner with the highest access latency.
+        uintptr_t num_lines = ((end - start) + 1) / (64 / sizeof(testword_t));
+        for (int j = 0; j < iterations; j++) {
+            ticks++;
+            if (my_cpu < 0) {
+                continue;
+            }
+            if (dram_access_supported()) {
+                prsg_state = prsg(prsg_state);
+                testword_t *addr1 = start + (prsg_state % num_lines) * (64 / sizeof(testword_t));
+                testword_t *addr2 = NULL;
+                if (dram_map.valid) {
+                    addr2 = find_double_sided(&addr1, start, end);
+                }
+                if (addr2 == NULL) {
+                    addr2 = find_partner(addr1, start, num_lines, &prsg_state);
+                }
+                if (addr2 != NULL) {
+                    test_addr[my_cpu] = (uintptr_t)addr1;
+                    uint64_t start_time = get_tsc();
+                    dram_access_pair(addr1, addr2, HAMMER_COUNT);
+                    uint64_t time = get_tsc() - start_time;
+                    if (time > 0) {
+                        // Two activations per iteration, reported in thousands per second.
+                        hammer_rate[my_cpu] = (2 * (uint64_t)HAMMER_COUNT * clks_per_msec) / time;
+                    }
+                }
+            }
+            do_tick(my_cpu);
+            BAILOUT;
+        }
+
+        // Check the chunk for flipped bits.
+        uintptr_t last_row  = UINTPTR_MAX;
+        uint32_t  row_flips = 0;
+        p  = start;
+        pe = start;
+
+        at_end = false;
+        do {
+            // take care to avoid pointer overflow
+            if ((end - pe) >= SPIN_SIZE) {
+                pe += SPIN_SIZE - 1;
+            } else {
+                at_end = true;
+                pe = end;
+            }
+            ticks++;
+            if (my_cpu < 0) {
+                continue;
+            }
+            test_addr[my_cpu] = (uintptr_t)p;
+            do {
+                testword_t actual = read_word(p);
+                if (unlikely(actual != pattern)) {
+                    uintptr_t row = phys_addr_of(p) >> (dram_map.valid ? dram_map.row_shift : ROW_SHIFT);
+                    uint32_t bits = count_bits(actual ^ pattern);
+                    flip_count[my_cpu] += bits;
+                    if (row != last_row) {
+                        flip_rows[my_cpu]++;
+                        last_row  = row;
+                        row_flips = 0;
+                    }
+                    row_flips += bits;
+                    if (row_flips > worst_row_flips[my_cpu]) {
+                        worst_row_flips[my_cpu] = row_flips;
+                        worst_row_addr[my_cpu]  = phys_addr_of(p);
+                    }
+                    data_error(p, pattern, actual, true);
+                }
+            } while (p++ < pe); // test before increment in case pointer overflows
+            do_tick(my_cpu);
+            BAILOUT;
+        } while (!at_end && ++pe); // advance pe to next start point
+
+        if (my_cpu == master_cpu) {
+            display_hammer_stats();
+        }
+    }
+
+    return ticks;
+}
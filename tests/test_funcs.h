@@ -13,6 +13,7 @@
 
 #include <stdbool.h>
 
+#include "config.h"
 #include "test.h"
 
 int test_addr_walk1(int my_cpu);
@@ -21,7 +22,7 @@ int test_own_addr1(int my_cpu);
 
 int test_own_addr2(int my_cpu, int stage);
 
-int test_mov_inv_fixed(int my_cpu, int iterations, testword_t pattern1, testword_t pattern2);
+int test_mov_inv_fixed(int my_cpu, int iterations, testword_t pattern1, testword_t pattern2, access_order_t order);
 
 int test_mov_inv_walk1(int my_cpu, int iterations, int offset, bool inverse);
 
@@ -29,8 +30,14 @@ int test_mov_inv_random(int my_cpu);
 
 int test_modulo_n(int my_cpu, int iterations, testword_t pattern1, testword_t pattern2, int n, int offset);
 
-int test_block_move(int my_cpu, int iterations);
+int test_block_move(int my_cpu, int iterations, copy_engine_t engine);
 
 int test_bit_fade(int my_cpu, int stage, int sleep_secs);
 
+int test_row_hammer(int my_cpu, int iterations, testword_t pattern);
+
+int test_bandwidth_stress(int my_cpu, int iterations, testword_t pattern, copy_engine_t engine);
+
+int test_cache_levels(int my_cpu, int iterations, testword_t pattern1, testword_t pattern2);
+
 #endif // TEST_FUNCS_H
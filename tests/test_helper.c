@@ -26,34 +26,51 @@
 #include "test_helper.h"
 
 //------------------------------------------------------------------------------
-// Public Functions
+// Private Functions
 //------------------------------------------------------------------------------
 
-void calculate_chunk(testword_t **start, testword_t **end, int my_cpu, int segment, size_t chunk_align)
+// Calculates the start and end word address of the given region of the
+// segment, when the segment is divided into num_regions equal parts.
+static void calculate_region(testword_t **start, testword_t **end, int segment, int region, int num_regions, size_t chunk_align)
 {
-    if (my_cpu < 0) {
-        my_cpu = 0;
+    uintptr_t segment_size = (vm_map[segment].end - vm_map[segment].start + 1) * sizeof(testword_t);
+    uintptr_t region_size  = round_down(segment_size / num_regions, chunk_align);
+
+    *start = (testword_t *)((uintptr_t)vm_map[segment].start + region_size * region);
+    *end   = (testword_t *)((uintptr_t)(*start) + region_size) - 1;
+    if (region == num_regions - 1) {
+        *end = vm_map[segment].end;
     }
+}
 
-    // If we are only running 1 CPU then test the whole segment.
+// Calculates the chunk of the range from range_start to range_end (which is
+// within the given segment) that is to be tested by my_cpu.
+static void divide_range(testword_t **start, testword_t **end, int my_cpu, int segment,
+                         testword_t *range_start, testword_t *range_end, size_t chunk_align)
+{
+    // If we are only running 1 CPU then test the whole range.
     if (num_active_cpus == 1) {
-        *start = vm_map[segment].start;
-        *end   = vm_map[segment].end;
+        *start = range_start;
+        *end   = range_end;
     } else {
         if (enable_numa) {
             uint32_t proximity_domain_idx = smp_get_proximity_domain_idx(my_cpu);
+            uint32_t test_domain_idx = proximity_domain_idx;
+            if (enable_numa_remote) {
+                test_domain_idx = smp_get_remote_proximity_domain_idx(proximity_domain_idx, pass_num);
+            }
 
-            // Is this CPU in the same proximity domain as the current segment ?
-            if (proximity_domain_idx == vm_map[segment].proximity_domain_idx) {
-                uintptr_t segment_size = (vm_map[segment].end - vm_map[segment].start + 1) * sizeof(testword_t);
-                uintptr_t chunk_size   = round_down(segment_size / used_cpus_in_proximity_domain[proximity_domain_idx], chunk_align);
+            // Is this CPU assigned to the proximity domain of the current segment ?
+            if (test_domain_idx == vm_map[segment].proximity_domain_idx) {
+                uintptr_t range_size = (range_end - range_start + 1) * sizeof(testword_t);
+                uintptr_t chunk_size = round_down(range_size / used_cpus_in_proximity_domain[proximity_domain_idx], chunk_align);
 
                 // Calculate chunk boundaries.
-                *start = (testword_t *)((uintptr_t)vm_map[segment].start + chunk_size * chunk_index[my_cpu]);
+                *start = (testword_t *)((uintptr_t)range_start + chunk_size * chunk_index[my_cpu]);
                 *end   = (testword_t *)((uintptr_t)(*start) + chunk_size) - 1;
 
-                if (*end > vm_map[segment].end) {
-                    *end = vm_map[segment].end;
+                if (*end > range_end) {
+                    *end = range_end;
                 }
             } else {
                 // Nope.
@@ -61,36 +78,88 @@ void calculate_chunk(testword_t **start, testword_t **end, int my_cpu, int segme
                 *end = (testword_t *)0;
             }
         } else {
-            uintptr_t segment_size = (vm_map[segment].end - vm_map[segment].start + 1) * sizeof(testword_t);
-            uintptr_t chunk_size   = round_down(segment_size / num_active_cpus, chunk_align);
+            uintptr_t range_size = (range_end - range_start + 1) * sizeof(testword_t);
+            uintptr_t chunk_size = round_down(range_size / num_active_cpus, chunk_align);
 
             // Calculate chunk boundaries.
-            *start = (testword_t *)((uintptr_t)vm_map[segment].start + chunk_size * chunk_index[my_cpu]);
+            *start = (testword_t *)((uintptr_t)range_start + chunk_size * chunk_index[my_cpu]);
             *end   = (testword_t *)((uintptr_t)(*start) + chunk_size) - 1;
 
-            if (*end > vm_map[segment].end) {
-                *end = vm_map[segment].end;
+            if (*end > range_end) {
+                *end = range_end;
             }
         }
     }
 }
 
-void flush_caches(int my_cpu)
+//------------------------------------------------------------------------------
+// Public Functions
+//------------------------------------------------------------------------------
+
+void calculate_chunk(testword_t **start, testword_t **end, int my_cpu, int segment, size_t chunk_align)
+{
+    if (my_cpu < 0) {
+        my_cpu = 0;
+    }
+
+    // If the CPUs are split into groups, each group tests its own region of
+    // the segment, divided between the CPUs in the group.
+    if (num_cpu_groups > 1) {
+        int group = cpu_group[my_cpu];
+        testword_t *region_start, *region_end;
+        calculate_region(&region_start, &region_end, segment, cpu_group_region[group], num_cpu_groups, chunk_align);
+
+        uintptr_t region_size = (region_end - region_start + 1) * sizeof(testword_t);
+        uintptr_t chunk_size  = round_down(region_size / cpu_group_size[group], chunk_align);
+
+        // Calculate chunk boundaries. The last CPU in the group takes any
+        // remainder, so that all the regions together cover the segment.
+        *start = (testword_t *)((uintptr_t)region_start + chunk_size * cpu_group_index[my_cpu]);
+        *end   = (testword_t *)((uintptr_t)(*start) + chunk_size) - 1;
+        if (cpu_group_index[my_cpu] == cpu_group_size[group] - 1 || *end > region_end) {
+            *end = region_end;
+        }
+        return;
+    }
+
+    divide_range(start, end, my_cpu, segment, vm_map[segment].start, vm_map[segment].end, chunk_align);
+}
+
+void calculate_region_chunk(testword_t **start, testword_t **end, int my_cpu, int segment,
+                            int region, int num_regions, size_t chunk_align)
+{
+    if (my_cpu < 0) {
+        my_cpu = 0;
+    }
+
+    testword_t *region_start, *region_end;
+    calculate_region(&region_start, &region_end, segment, region, num_regions, chunk_align);
+    if (region_end < region_start) {
+        *start = (testword_t *)1;
+        *end   = (testword_t *)0;
+        return;
+    }
+    divide_range(start, end, my_cpu, segment, region_start, region_end, chunk_align);
+}
+
+void sync_test_cpus(int my_cpu)
 {
     if (my_cpu >= 0) {
-        bool use_spin_wait = (power_save < POWER_SAVE_HIGH);
-        if (use_spin_wait) {
-            barrier_spin_wait(run_barrier);
+        if (power_save < POWER_SAVE_HIGH) {
+            barrier_spin_wait(test_barrier(my_cpu));
         } else {
-            barrier_halt_wait(run_barrier);
+            barrier_halt_wait(test_barrier(my_cpu));
         }
-        if (my_cpu == master_cpu) {
+    }
+}
+
+void flush_caches(int my_cpu)
+{
+    if (my_cpu >= 0) {
+        sync_test_cpus(my_cpu);
+        if (is_group_leader(my_cpu)) {
             cache_flush();
         }
-        if (use_spin_wait) {
-            barrier_spin_wait(run_barrier);
-        } else {
-            barrier_halt_wait(run_barrier);
-        }
+        sync_test_cpus(my_cpu);
     }
 }
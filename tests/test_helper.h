@@ -92,6 +92,20 @@ static inline testword_t prsg(testword_t state)
  */
 void calculate_chunk(testword_t **start, testword_t **end, int my_cpu, int segment, size_t chunk_align);
 
+/**
+ * As calculate_chunk(), but only for the given region of the segment, when
+ * the segment is divided into num_regions equal parts. Ignores any CPU core
+ * groups.
+ */
+void calculate_region_chunk(testword_t **start, testword_t **end, int my_cpu, int segment,
+                            int region, int num_regions, size_t chunk_align);
+
+/**
+ * Waits for all the CPU cores running the same test as my_cpu to reach this
+ * point. Does nothing if my_cpu is negative.
+ */
+void sync_test_cpus(int my_cpu);
+
 /**
  * Flushes the CPU caches. If SMP is enabled, synchronises the threads before
  * and after issuing the cache flush instruction.
@@ -17,8 +17,8 @@
 
 #include "boot.h"
 
-#include "cache.h"
 #include "cpuid.h"
+#include "dram_map.h"
 #include "memsize.h"
 #include "tsc.h"
 #include "vmem.h"
@@ -29,6 +29,8 @@
 #include "display.h"
 #include "test.h"
 
+#include "access_order.h"
+#include "copy_engine.h"
 #include "test_funcs.h"
 #include "test_helper.h"
 
@@ -44,15 +46,19 @@
 
 #define MODULO_N            20
 
+// The number of different tests run concurrently by test 12. This is also
+// the maximum number of CPU core groups used.
+#define NUM_CONCURRENT_TESTS    3
+
 //------------------------------------------------------------------------------
 // Public Variables
 //------------------------------------------------------------------------------
 
 test_pattern_t test_list[NUM_TEST_PATTERNS] = {
     // ena,  cpu, stgs, itrs, errs, description
-    { true,  ONE,    1,    6,    0, "[Address test, walking ones, no cache] "},
-    {false,  ONE,    1,    6,    0, "[Address test, own address in window]  "},
-    { true,  ONE,    2,    6,    0, "[Address test, own address + window]   "},
+    { true,  PAR,    1,    6,    0, "[Address test, walking ones, no cache] "},
+    {false,  PAR,    1,    6,    0, "[Address test, own address in window]  "},
+    { true,  PAR,    2,    6,    0, "[Address test, own address + window]   "},
     { true,  PAR,    1,    6,    0, "[Moving inversions, 1s & 0s]           "},
     { true,  PAR,    1,    3,    0, "[Moving inversions, 8 bit pattern]     "},
     { true,  PAR,    1,   30,    0, "[Moving inversions, random pattern]    "},
@@ -64,31 +70,211 @@ test_pattern_t test_list[NUM_TEST_PATTERNS] = {
     { true,  PAR,    1,   81,    0, "[Block move]                           "},
     { true,  PAR,    1,   48,    0, "[Random number sequence]               "},
     { true,  PAR,    1,    6,    0, "[Modulo 20, random pattern]            "},
-    { true,  ONE,    6,  240,    0, "[Bit fade test, 2 patterns]            "},
+    { true,  PAR,    6,  240,    0, "[Bit fade test, 2 patterns]            "},
+    { true,  PAR,    1,   32,    0, "[Row hammer, random aggressor pairs]   "},
+    { true,  PAR,    1,    2,    0, "[Concurrent tests, core groups]        "},
+    { true,  PAR,    1,   16,    0, "[Bandwidth stress, copy and compare]   "},
+    { true,  PAR,    1,   64,    0, "[Cache hierarchy, moving inversions]   "},
 };
 
 int ticks_per_pass[NUM_PASS_TYPES];
 int ticks_per_test[NUM_PASS_TYPES][NUM_TEST_PATTERNS];
 
 //------------------------------------------------------------------------------
-// Public Functions
+// Private Functions
 //------------------------------------------------------------------------------
 
-#define BARRIER \
+#define WAIT_ON(barrier) \
     if (my_cpu >= 0) { \
         if (TRACE_BARRIERS) { \
             trace(my_cpu, "Run barrier wait begin at %s line %i", __FILE__, __LINE__); \
         } \
         if (power_save < POWER_SAVE_HIGH) { \
-            barrier_spin_wait(run_barrier); \
+            barrier_spin_wait(barrier); \
         } else { \
-            barrier_halt_wait(run_barrier); \
+            barrier_halt_wait(barrier); \
         } \
         if (TRACE_BARRIERS) { \
             trace(my_cpu, "Run barrier wait end at %s line %i", __FILE__, __LINE__); \
         } \
     }
 
+// Synchronises the CPUs running the same test as my_cpu.
+#define BARRIER         WAIT_ON(test_barrier(my_cpu))
+
+// Synchronises all the active CPUs, even if they are split into groups.
+#define ALL_BARRIER     WAIT_ON(run_barrier)
+
+
+// Discovers the DRAM bank/row mapping the first time the row hammer test is
+// run, using the largest memory segment in the current window. This is done
+// once only, as it takes a while and the result does not change.
+static void discover_dram_map(void)
+{
+    static bool attempted = false;
+
+    if (attempted) {
+        return;
+    }
+    attempted = true;
+
+    int largest = 0;
+    for (int i = 1; i < vm_map_size; i++) {
+        if ((vm_map[i].end - vm_map[i].start) > (vm_map[largest].end - vm_map[largest].start)) {
+            largest = i;
+        }
+    }
+    size_t size = (vm_map[largest].end - vm_map[largest].start + 1) * sizeof(testword_t);
+    if (dram_map_discover(vm_map[largest].start, size)) {
+        trace(master_cpu, "DRAM map: row shift %i, %i bank functions up to bit %i",
+              dram_map.row_shift, dram_map.num_bank_fns, dram_map.max_bit);
+        for (int i = 0; i < dram_map.num_bank_fns; i++) {
+            trace(master_cpu, "  bank fn %i: 0x%x", i, (uintptr_t)dram_map.bank_fn[i]);
+        }
+    } else {
+        trace(master_cpu, "DRAM map discovery failed");
+    }
+}
+
+// Sets up the access order used by the moving inversions tests in this pass.
+// The DRAM mapping is needed for any order other than linear.
+static access_order_t select_access_order(int my_cpu)
+{
+    access_order_t order = access_order_for_pass(pass_num);
+    if (my_cpu == master_cpu) {
+        if (order != ACCESS_ORDER_LINEAR) {
+            discover_dram_map();
+        }
+        access_order_select(order, 0x12345678 + pass_num * 0x9e3779b9);
+    }
+    return order;
+}
+
+// Splits the active CPUs into groups, one for each concurrent test (or fewer
+// if there are not enough CPUs), each testing its own region of memory. The
+// master CPU is the first CPU in group 0, so it still updates the display.
+static void setup_cpu_groups(void)
+{
+    int num_groups = num_active_cpus < NUM_CONCURRENT_TESTS ? num_active_cpus : NUM_CONCURRENT_TESTS;
+    if (num_groups < 2) {
+        return;
+    }
+    for (int group = 0; group < num_groups; group++) {
+        cpu_group_size[group]   = 0;
+        cpu_group_region[group] = group;
+    }
+    int n = 0;
+    for (int i = 0; i < num_available_cpus; i++) {
+        int cpu = (master_cpu + i) % num_available_cpus;
+        if (cpu_state[cpu] == CPU_STATE_DISABLED || cpu == service_cpu) {
+            continue;
+        }
+        int group = n++ % num_groups;
+        cpu_group[cpu]       = group;
+        cpu_group_index[cpu] = cpu_group_size[group]++;
+    }
+    for (int group = 0; group < num_groups; group++) {
+        barrier_reset(group_barrier[group], cpu_group_size[group]);
+    }
+    num_cpu_groups = num_groups;
+}
+
+static int run_concurrent_test(int my_cpu, int concurrent_test, int iterations)
+{
+    testword_t prsg_state;
+
+    int ticks = 0;
+
+    switch (concurrent_test) {
+        // Moving inversions, all ones and zeros.
+      case 0: {
+        testword_t pattern1 = 0;
+        testword_t pattern2 = ~pattern1;
+
+        BARRIER;
+        ticks += test_mov_inv_fixed(my_cpu, iterations, pattern1, pattern2, ACCESS_ORDER_LINEAR);
+        BAILOUT;
+
+        BARRIER;
+        ticks += test_mov_inv_fixed(my_cpu, iterations, pattern2, pattern1, ACCESS_ORDER_LINEAR);
+        BAILOUT;
+      } break;
+
+        // Moving inversions, fully random patterns.
+      case 1:
+        for (int i = 0; i < iterations; i++) {
+            BARRIER;
+            ticks += test_mov_inv_random(my_cpu);
+            BAILOUT;
+        }
+        break;
+
+        // Modulo 20 check, fixed random pattern.
+      case 2:
+        if (cpuid_info.flags.rdtsc) {
+            prsg_state = get_tsc();
+        } else {
+            prsg_state = 1 + pass_num;
+        }
+        prsg_state *= 0x87654321;
+
+        for (int i = 0; i < iterations; i++) {
+            for (int offset = 0; offset < MODULO_N; offset++) {
+                prsg_state = prsg(prsg_state);
+
+                testword_t pattern1 = prsg_state;
+                testword_t pattern2 = ~pattern1;
+
+                BARRIER;
+                ticks += test_modulo_n(my_cpu, 2, pattern1, pattern2, MODULO_N, offset);
+                BAILOUT;
+            }
+        }
+        break;
+    }
+    return ticks;
+}
+
+// Runs the concurrent tests in a series of rounds. In each round, each group
+// of CPUs runs a different test on its own region of memory, and the tests
+// move on to the next group in the next round, so by the end each test has
+// covered all the memory. If there is only one group, the tests are run one
+// after the other in the usual way.
+static int run_concurrent_tests(int my_cpu, int iterations)
+{
+    int ticks = 0;
+
+    // The iteration count is reduced in the first pass, but each test must
+    // still run at least once.
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    if (my_cpu == master_cpu) {
+        setup_cpu_groups();
+    }
+    ALL_BARRIER;
+
+    int group = (my_cpu >= 0) ? cpu_group[my_cpu] : 0;
+    if (num_cpu_groups < 2) {
+        group = 0;
+    }
+    for (int round = 0; round < NUM_CONCURRENT_TESTS; round++) {
+        ticks += run_concurrent_test(my_cpu, (group + round) % NUM_CONCURRENT_TESTS, iterations);
+        // A group may bail out part way through a test, so wait for all the
+        // groups to reach the same point before checking.
+        ALL_BARRIER;
+        BAILOUT;
+    }
+
+    return ticks;
+}
+
+//------------------------------------------------------------------------------
+// Public Functions
+//------------------------------------------------------------------------------
+
+
 int run_test(int my_cpu, int test, int stage, int iterations)
 {
     if (my_cpu == master_cpu) {
@@ -116,9 +302,7 @@ int run_test(int my_cpu, int test, int stage, int iterations)
     switch (test) {
         // Address test, walking ones.
       case 0:
-        if (my_cpu >= 0) cache_off();
         ticks += test_addr_walk1(my_cpu);
-        if (my_cpu >= 0) cache_on();
         BAILOUT;
         break;
 
@@ -138,13 +322,14 @@ int run_test(int my_cpu, int test, int stage, int iterations)
       case 3: {
         testword_t pattern1 = 0;
         testword_t pattern2 = ~pattern1;
+        access_order_t order = select_access_order(my_cpu);
 
         BARRIER;
-        ticks += test_mov_inv_fixed(my_cpu, iterations, pattern1, pattern2);
+        ticks += test_mov_inv_fixed(my_cpu, iterations, pattern1, pattern2, order);
         BAILOUT;
 
         BARRIER;
-        ticks += test_mov_inv_fixed(my_cpu, iterations, pattern2, pattern1);
+        ticks += test_mov_inv_fixed(my_cpu, iterations, pattern2, pattern1, order);
         BAILOUT;
       } break;
 
@@ -155,15 +340,16 @@ int run_test(int my_cpu, int test, int stage, int iterations)
 #else
             testword_t pattern1 = 0x80808080;
 #endif
+        access_order_t order = select_access_order(my_cpu);
         for (int i = 0; i < 8; i++) {
             testword_t pattern2 = ~pattern1;
 
             BARRIER;
-            ticks += test_mov_inv_fixed(my_cpu, iterations, pattern1, pattern2);
+            ticks += test_mov_inv_fixed(my_cpu, iterations, pattern1, pattern2, order);
             BAILOUT;
 
             BARRIER;
-            ticks += test_mov_inv_fixed(my_cpu, iterations, pattern2, pattern1);
+            ticks += test_mov_inv_fixed(my_cpu, iterations, pattern2, pattern1, order);
             BAILOUT;
 
             pattern1 >>= 1;
@@ -179,6 +365,7 @@ int run_test(int my_cpu, int test, int stage, int iterations)
         }
         prsg_state *= 0x12345678;
 
+        access_order_t order = select_access_order(my_cpu);
         for (int i = 0; i < iterations; i++) {
             prsg_state = prsg(prsg_state);
 
@@ -186,7 +373,7 @@ int run_test(int my_cpu, int test, int stage, int iterations)
             testword_t pattern2 = ~pattern1;
 
             BARRIER;
-            ticks += test_mov_inv_fixed(my_cpu, 2, pattern1, pattern2);
+            ticks += test_mov_inv_fixed(my_cpu, 2, pattern1, pattern2, order);
             BAILOUT;
         }
         break;
@@ -206,7 +393,7 @@ int run_test(int my_cpu, int test, int stage, int iterations)
 
         // Block move.
       case 7:
-        ticks += test_block_move(my_cpu, iterations);
+        ticks += test_block_move(my_cpu, iterations, copy_engine_for_pass(pass_num));
         BAILOUT;
         break;
 
@@ -251,6 +438,53 @@ int run_test(int my_cpu, int test, int stage, int iterations)
         ticks += test_bit_fade(my_cpu, stage, iterations);
         BAILOUT;
         break;
+
+        // Row hammer test.
+      case 11: {
+#if TESTWORD_WIDTH > 32
+        testword_t pattern1 = UINT64_C(0x5555555555555555);
+#else
+        testword_t pattern1 = 0x55555555;
+#endif
+        testword_t pattern2 = ~pattern1;
+
+        if (my_cpu == master_cpu) {
+            discover_dram_map();
+        }
+
+        BARRIER;
+        ticks += test_row_hammer(my_cpu, iterations, pattern1);
+        BAILOUT;
+
+        BARRIER;
+        ticks += test_row_hammer(my_cpu, iterations, pattern2);
+        BAILOUT;
+      } break;
+
+        // Concurrent tests.
+      case 12:
+        ticks += run_concurrent_tests(my_cpu, iterations);
+        BAILOUT;
+        break;
+
+        // Bandwidth stress test.
+      case 13: {
+        testword_t pattern = prsg(0x87654321 * (1 + pass_num));
+
+        BARRIER;
+        ticks += test_bandwidth_stress(my_cpu, iterations, pattern, copy_engine_widest());
+        BAILOUT;
+      } break;
+
+        // Cache hierarchy test.
+      case 14: {
+        testword_t pattern1 = prsg(0x12345678 * (1 + pass_num));
+        testword_t pattern2 = ~pattern1;
+
+        BARRIER;
+        ticks += test_cache_levels(my_cpu, iterations, pattern1, pattern2);
+        BAILOUT;
+      } break;
     }
     return ticks;
 }